@@ -0,0 +1,115 @@
+#ifndef ALLOCATIONS_H
+#define ALLOCATIONS_H
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+
+// the allocation statistics of a task
+const int ALLOC_COUNT = 0;  // how many blocks the task allocated
+const int ALLOC_BYTES = 1;  // how many bytes the task allocated
+const int ALLOC_PEAK  = 2;  // the most bytes the task held at once
+const int ALLOC_RSS   = 3;  // the resident size of the process when it ended (kB)
+const int ALLOC_STATS = 4;
+
+extern const char* ALLOC_NAMES[ALLOC_STATS];
+
+/*
+ * Counts the allocations of the matrices, permutations, and the thread
+ * pool's queue. Each thread keeps the numbers of the task it is running,
+ * and the whole process keeps the bytes that are live and the most that
+ * ever were, so memory that grows over a long batch shows up. Counting is
+ * always on so frees always match their allocations; it costs a few adds
+ * per allocation, and nothing is allocated in the evaluation loop.
+ */
+class Allocations {
+private:
+    static std::atomic<long long> blocks;       // allocations made by every thread
+    static std::atomic<long long> bytes;        // bytes allocated by every thread
+    static std::atomic<long long> live;         // bytes allocated and not yet freed
+    static std::atomic<long long> peak;         // the most bytes live at once
+
+public:
+    template<class T> static T*   allocate(const size_t count);
+    template<class T> static void release(T* block, const size_t count);
+    static void counted(const size_t size);
+    static void freed(const size_t size);
+    static void adopt(const long long count, const long long size);
+
+    // functions for a task
+    static void beginTask();
+    static void endTask(long long* stats);
+
+    // functions for the process
+    static long long getLive();
+    static long long getPeak();
+    static long long getBlocks();
+    static long long getBytes();
+    static long long residentKB();
+    static long long peakResidentKB();
+};
+
+/**
+ * @brief Allocates and counts an array
+ *
+ * @tparam T        The element type
+ * @param count     How many elements
+ * @return T*       The array, as from new[]
+ */
+template<class T>
+T* Allocations::allocate(const size_t count)
+{
+    T* block = new T[count];
+    counted(count * sizeof(T));
+    return block;
+}
+
+/**
+ * @brief Frees an array from allocate()
+ *
+ * @tparam T        The element type
+ * @param block     The array, or nullptr
+ * @param count     How many elements it was allocated with
+ */
+template<class T>
+void Allocations::release(T* block, const size_t count)
+{
+    if (block == nullptr)
+        return;
+
+    delete[] block;
+    freed(count * sizeof(T));
+}
+
+/*
+ * A standard allocator that counts what it allocates, for the containers
+ * of the thread pool
+ */
+template<class T>
+struct CountingAllocator {
+    typedef T value_type;
+
+    CountingAllocator() {}
+    template<class U> CountingAllocator(const CountingAllocator<U>&) {}
+
+    T* allocate(const size_t count)
+    {
+        T* block = static_cast<T*>(::operator new(count * sizeof(T)));
+        Allocations::counted(count * sizeof(T));
+        return block;
+    }
+
+    void deallocate(T* block, const size_t count)
+    {
+        ::operator delete(block);
+        Allocations::freed(count * sizeof(T));
+    }
+};
+
+template<class T, class U>
+bool operator==(const CountingAllocator<T>&, const CountingAllocator<U>&) { return true; }
+
+template<class T, class U>
+bool operator!=(const CountingAllocator<T>&, const CountingAllocator<U>&) { return false; }
+
+#endif
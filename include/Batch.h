@@ -0,0 +1,21 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "Bundle.h"
+#include "InstanceLoader.h"
+#include "ResultCache.h"
+#include "ResultWriter.h"
+#include "ThreadPool.h"
+
+// the shared pieces of a batch that every task needs
+struct Batch {
+    ThreadPool*   pool;     // the workers the tasks run on
+    ResultWriter* writer;   // where finished results are handed to
+    Bundle*       bundle;   // the instances, or nullptr to read DataFiles
+    InstanceLoader* loader; // reads the instances ahead, or nullptr to read them in the task
+    ResultCache*  cache;    // results solved before, or nullptr to solve everything
+    bool          counting; // whether each task counts its hardware events
+    bool          accounting; // whether each task reports its allocations
+};
+
+#endif
@@ -0,0 +1,73 @@
+#ifndef BUNDLE_H
+#define BUNDLE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Matrix.h"
+
+using namespace std;
+
+/*
+ * A bundle packs a whole suite of instances into one file: a header, an
+ * index with one entry per instance, and the processing times of every
+ * instance (native integers, row by row, each block 64 byte aligned).
+ * The file is mapped once and every Matrix is a view into it.
+ */
+const char     BUNDLE_MAGIC[4] = { 'F', 'S', 'B', 'N' };
+const uint32_t BUNDLE_VERSION  = 1;
+const int      BUNDLE_TAG_SIZE = 16;
+
+struct BundleHeader {
+    char     magic[4];      // always BUNDLE_MAGIC
+    uint32_t version;       // the version of the format
+    uint32_t count;         // how many instances are in the bundle
+    uint32_t width;         // the size of one processing time in bytes
+    uint64_t indexOffset;   // where the index starts
+    uint64_t reserved[5];   // pads the header to 64 bytes
+};
+
+struct BundleEntry {
+    uint32_t id;                    // the datafile number of the instance
+    uint32_t rows;                  // the number of machines
+    uint32_t cols;                  // the number of jobs
+    uint32_t reserved;              // unused, keeps offset aligned
+    uint64_t offset;                // where the processing times start
+    char     tag[BUNDLE_TAG_SIZE];  // a free form label, such as "5x20"
+};
+
+static_assert(sizeof(BundleHeader) == 64, "the bundle header must be 64 bytes");
+static_assert(sizeof(BundleEntry)  == 40, "a bundle entry must be 40 bytes");
+
+class Bundle {
+private:
+    void*  mapping;     // the mapped file
+    size_t size;        // the size of the mapping in bytes
+
+    const BundleHeader* header;     // the header at the start of the file
+    const BundleEntry*  entries;    // the index
+
+public:
+    Bundle();
+    ~Bundle();
+
+    // functions for the file
+    bool open(const string pathname);
+    bool isOpen();
+
+    // functions for the index
+    int   getCount();
+    const BundleEntry* getEntry(const int elem);
+    const BundleEntry* find(const int id);
+    vector<int> select(const int first, const int last, const string tag);
+
+    // functions for the instances
+    Matrix* getMatrix(const int id);
+};
+
+bool writeBundle(const string pathname, const vector<int>& ids, const vector<string>& tags);
+bool writeBundle(const string pathname, const vector<int>& ids, const vector<Matrix*>& instances,
+                 const vector<string>& tags);
+
+#endif
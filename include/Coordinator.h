@@ -0,0 +1,27 @@
+#ifndef COORDINATOR_H
+#define COORDINATOR_H
+
+#include <string>
+
+using namespace std;
+
+/*
+ * The coordinator and its workers talk over a stream socket with one
+ * message per line:
+ *
+ *      coordinator -> worker   TASK <datafile> <alg>
+ *                              QUIT
+ *      worker -> coordinator   HELLO <pid>
+ *                              RESULT <record from resultToLine()>
+ *
+ * Nothing in the protocol depends on the socket being local, so a worker
+ * can be served over a TCP connection just the same.
+ */
+
+void runCoordinator(const int processes);
+void serveWorker(const int fd);
+
+bool readLine(const int fd, string& buffer, string& line);
+bool writeLine(const int fd, const string line);
+
+#endif
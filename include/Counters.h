@@ -0,0 +1,41 @@
+#ifndef COUNTERS_H
+#define COUNTERS_H
+
+// the hardware events counted for each task
+const int COUNTER_CYCLES        = 0; // cpu cycles
+const int COUNTER_INSTRUCTIONS  = 1; // instructions retired
+const int COUNTER_L1D_MISSES    = 2; // level 1 data cache read misses
+const int COUNTER_LLC_MISSES    = 3; // last level cache read misses
+const int COUNTER_BRANCH_MISSES = 4; // mispredicted branches
+const int COUNTER_COUNT         = 5;
+
+extern const char* COUNTER_NAMES[COUNTER_COUNT];
+
+/*
+ * The hardware counters of one thread, opened with perf_event_open. Each
+ * event is opened on its own, so an event the machine does not have is left
+ * out without losing the others. When none can be opened the counts are
+ * simply not measured (-1).
+ */
+class Counters {
+private:
+    int  fds[COUNTER_COUNT];    // the file descriptor of each event, or -1
+    bool opened;                // set once opening has been tried
+    bool running;               // set between start() and stop()
+
+    void open();
+
+public:
+    Counters();
+    ~Counters();
+
+    // functions for a task
+    void start();
+    void stop(long long* counts);
+    bool isRunning();
+
+    static Counters* forThread();
+    static Counters* forHelper();
+};
+
+#endif
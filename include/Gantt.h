@@ -0,0 +1,121 @@
+#ifndef GANTT_H
+#define GANTT_H
+
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/*
+ * The binary Gantt format, a columnar alternative to the Gantt CSV. A 64
+ * byte header is followed by three contiguous arrays of native integers:
+ *      sequence    cols values, the job (column of the datafile) at each position
+ *      start       rows*cols values, the start times, one machine after the other
+ *      end         rows*cols values, the end times, laid out the same way
+ * so start[m*cols + p] and end[m*cols + p] belong to the job at position p of
+ * the sequence on machine m. Each array starts on an 8 byte boundary.
+ *
+ * This header is also the reader: include it and use GanttView to map a
+ * file and read the arrays in place, with no parsing or copying.
+ */
+const char     GANTT_MAGIC[4] = { 'F', 'S', 'G', 'T' };
+const uint32_t GANTT_VERSION  = 1;
+
+struct GanttHeader {
+    char     magic[4];          // always GANTT_MAGIC
+    uint32_t version;           // the version of the format
+    uint32_t datafile;          // which datafile was scheduled
+    uint32_t alg;               // which algorithm scheduled it (1 FSS, 2 FSSB, 3 FSSNW)
+    uint32_t rows;              // the number of machines
+    uint32_t cols;              // the number of jobs
+    uint32_t width;             // the size of one value in bytes
+    int32_t  cmax;              // the makespan of the schedule
+    uint64_t sequenceOffset;    // where the sequence starts
+    uint64_t startOffset;       // where the start times start
+    uint64_t endOffset;         // where the end times start
+    uint64_t reserved;          // pads the header to 64 bytes
+};
+
+static_assert(sizeof(GanttHeader) == 64, "the gantt header must be 64 bytes");
+
+// a read-only, zero copy view of a binary Gantt file
+class GanttView {
+private:
+    void*  mapping;     // the mapped file
+    size_t size;        // the size of the mapping in bytes
+
+    const GanttHeader* header;  // the header at the start of the file
+
+    const int* at(const uint64_t offset) const
+    {
+        return reinterpret_cast<const int*>(static_cast<const char*>(mapping) + offset);
+    }
+
+public:
+    GanttView() : mapping(nullptr), size(0), header(nullptr) {}
+    ~GanttView() { close(); }
+
+    // maps a file, returns false if it can't be read or is not a Gantt file
+    bool open(const std::string pathname)
+    {
+        close();
+
+        int fd = ::open(pathname.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+
+        struct stat info;
+        size = (fstat(fd, &info) == 0) ? info.st_size : 0;
+        void* mapped = (size > 0) ? mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+        ::close(fd);
+
+        if (mapped == MAP_FAILED)
+            return false;
+
+        mapping = mapped;
+        header  = static_cast<const GanttHeader*>(mapping);
+
+        // every array must lie inside the file
+        uint64_t cells = (uint64_t)header->rows * header->cols * sizeof(int);
+        if (size < sizeof(GanttHeader) || memcmp(header->magic, GANTT_MAGIC, 4) != 0 ||
+            header->version != GANTT_VERSION || header->width != sizeof(int) ||
+            header->sequenceOffset + (uint64_t)header->cols * sizeof(int) > size ||
+            header->startOffset + cells > size || header->endOffset + cells > size)
+        {
+            close();
+            return false;
+        }
+
+        return true;
+    }
+
+    // unmaps the file, every pointer from the view becomes invalid
+    void close()
+    {
+        if (mapping != nullptr)
+            munmap(mapping, size);
+
+        mapping = nullptr;
+        header  = nullptr;
+        size    = 0;
+    }
+
+    bool isOpen()      const { return mapping != nullptr; }
+    int  getDatafile() const { return header->datafile; }
+    int  getAlg()      const { return header->alg; }
+    int  getRows()     const { return header->rows; }
+    int  getCols()     const { return header->cols; }
+    int  getCmax()     const { return header->cmax; }
+
+    // the job at each position of the sequence
+    const int* getSequence() const { return at(header->sequenceOffset); }
+
+    // the start and end times of every position on one machine
+    const int* getStart(const int machine) const { return at(header->startOffset) + (size_t)machine * header->cols; }
+    const int* getEnd  (const int machine) const { return at(header->endOffset)   + (size_t)machine * header->cols; }
+};
+
+#endif
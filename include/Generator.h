@@ -0,0 +1,61 @@
+#ifndef GENERATOR_H
+#define GENERATOR_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Matrix.h"
+
+using namespace std;
+
+// the distributions of the processing times
+const int DIST_UNIFORM    = 0; // Taillard's 1 to 99, every value as likely
+const int DIST_CORRELATED = 1; // each job has a typical time, every machine is near it
+const int DIST_HEAVY      = 2; // mostly short times with a few very long ones (Pareto)
+
+int parseDistribution(const string name);
+
+/*
+ * Taillard's random number generator (1993), the linear congruential
+ * generator x = 16807 x mod (2^31 - 1), computed without overflow with
+ * Schrage's method. The Taillard instances were made with it, so they can
+ * be made again from their seeds.
+ */
+class Taillard {
+private:
+    int32_t seed;       // the state of the generator
+
+public:
+    Taillard(const int32_t s);
+
+    double next();
+    int    unif(const int low, const int high);
+};
+
+/*
+ * Makes the processing times of an instance one machine (row) at a time, in
+ * the order Taillard made them, so an instance of any size can be written
+ * while it is made.
+ */
+class Generator {
+private:
+    int rows;           // the number of machines
+    int cols;           // the number of jobs
+    int dist;           // the distribution (DIST_*)
+    Taillard random;    // the generator of every value
+    vector<int> base;   // the typical time of each job (correlated only)
+
+public:
+    Generator(const int r, const int c, const int32_t seed, const int distribution);
+
+    void nextRow(int* row);
+    Matrix* makeMatrix();
+};
+
+bool taillardInstance(const int number, int32_t& seed, int& rows, int& cols);
+int  taillardUpperBound(const int number);
+bool writeGenerated(const string pathname, const int rows, const int cols, const int32_t seed,
+                    const int dist, const bool binary);
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef INSTANCE_H
+#define INSTANCE_H
+
+#include <cstdint>
+#include <string>
+
+#include "Matrix.h"
+
+using namespace std;
+
+/*
+ * The binary instance format. A 64 byte header is followed by the
+ * processing times as rows*cols native (little endian) integers, one row
+ * (machine) after the other, so the block can be mapped and used as is.
+ */
+const char     INSTANCE_MAGIC[4] = { 'F', 'S', 'S', 'I' };
+const uint32_t INSTANCE_VERSION  = 1;
+const uint32_t INSTANCE_HEADER   = 64;
+
+struct InstanceHeader {
+    char     magic[4];      // always INSTANCE_MAGIC
+    uint32_t version;       // the version of the format
+    uint32_t rows;          // the number of machines
+    uint32_t cols;          // the number of jobs
+    uint32_t width;         // the size of one processing time in bytes
+    uint32_t offset;        // where the processing times start
+    uint32_t reserved[10];  // pads the header to 64 bytes
+};
+
+static_assert(sizeof(InstanceHeader) == INSTANCE_HEADER, "the instance header must be 64 bytes");
+
+InstanceHeader makeInstanceHeader(const int rows, const int cols);
+string checkInstanceHeader(const InstanceHeader* header, const size_t fileSize);
+bool   writeInstance(const string pathname, Matrix* jobs);
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef INSTANCE_LOADER_H
+#define INSTANCE_LOADER_H
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "Bundle.h"
+#include "Matrix.h"
+
+using namespace std;
+
+class InstanceLoader {
+private:
+    vector<int> order;      // the datafiles in the order the tasks need them
+    Bundle*     bundle;     // where the instances come from, or nullptr
+    size_t      budget;     // how many bytes may be loaded ahead of the workers
+    bool        localCopy;  // whether workers copy the instance into their own memory
+    bool        done;       // set once the loader should stop
+
+    size_t next;            // the position in order of the next instance to load
+    size_t readyBytes;      // the bytes of the instances waiting in ready
+
+    long   loaded;          // how many instances the loader thread loaded
+    long   stalls;          // how many takes had to wait for their instance
+    double stallTime;       // total time (ms) workers spent waiting for instances
+    double loadTime;        // total time (ms) the loader thread spent loading
+
+    deque< pair<int, Matrix*> > ready;  // the loaded instances, in order
+
+    mutex queueMutex;
+    condition_variable notEmpty;
+    condition_variable notFull;
+    thread loader;
+
+    void fill();
+    Matrix* load(const int datafile);
+    Matrix* copyLocal(Matrix* jobs);
+
+public:
+    InstanceLoader(const vector<int>& datafiles, Bundle* source, const size_t bytes, const bool copy);
+    ~InstanceLoader();
+
+    // functions for the workers
+    Matrix* take(const int datafile);
+
+    // functions for the batch
+    void finish();
+    void report();
+};
+
+#endif
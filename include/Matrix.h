@@ -14,18 +14,33 @@ private:
     int cols;
 
     int*  jobCosts;     // holds the total cost of each column
-    int** matrix;       // [rows][cols]
+    int*  data;         // every element, one row after the other
+    int** matrix;       // [rows][cols], each row points into data (or the mapping)
+
+    void*  mapping;     // the mapped binary instance, if this is a read-only view
+    size_t mappingSize; // the size of the mapping in bytes
+    bool   borrowed;    // whether the elements belong to someone else (a bundle)
+
+    void allocate(const int newRows, const int newCols);
+    void load(const string pathname);
+    void loadBinary(const string pathname);
+    void release();
+    static bool scanInt(const char*& pos, const char* end, long long& val);
 
 public:
     // constructors and destructors
     Matrix(const int row, const int col);
     Matrix(int fileName);
     Matrix(string fileName);
+    Matrix(const int* values, const int row, const int col);
     ~Matrix();
 
     // functions for constants
-    int getCols();
-    int getRows();
+    int  getCols();
+    int  getRows();
+    bool isView();
+    int  countBlocks();
+    long long countBytes();
 
     // functions for jobCosts
     void generateJobCosts();
@@ -35,12 +50,15 @@ public:
     // functions for matrix
     int  getVal(const int row, const int col);
     int  getFinalVal();
+    int* getRow(const int row);
     void setVal(int newVal, const int row, const int col);
     void clearMatrix();
 
     // misc functions
     void resize(const int newRows, const int newCols);
     void print();
+
+    static void reportParsing();
 };
 
 #endif
@@ -2,14 +2,46 @@
 #ifndef MEMORY_H
 #define MEMORY_H
 
-// #include <ctime>
+#include <chrono>
+#include <string>
+
+#include "Allocations.h"
+#include "Counters.h"
+#include "OutputBuffer.h"
+
+// which Gantt files are written, any combination of the flags
+const int GANTT_CSV    = 1; // the Item,Machine,Job,Start,End text file
+const int GANTT_BINARY = 2; // the columnar binary file (see Gantt.h)
+
+// how much is written for each result
+const int OUTPUT_SUMMARY  = 0; // a row in the summary table
+const int OUTPUT_SCHEDULE = 1; // the row also holds the job sequence
+const int OUTPUT_FULL     = 2; // the rawData and Gantt files as well
+
+// the phases of a task that are timed separately
+const int PHASE_LOAD   = 0; // reading the instance
+const int PHASE_SORT   = 1; // sorting the jobs (and splitting them into blocks)
+const int PHASE_NEH    = 2; // the NEH construction
+const int PHASE_REPAIR = 3; // improving the sequence (the seam repair)
+const int PHASE_WRITE  = 4; // writing the rawData and Gantt files
+const int PHASE_COUNT  = 5;
+
+extern const char* PHASE_NAMES[PHASE_COUNT];
+
+int parseGanttFormat(const std::string name);
+int parseOutputLevel(const std::string name);
 
 class Memory {
 private:
     int    funcCalls;   // how many function calls the algorithm used
+    int    originalCmax;// the makespan of the jobs in their original order
 
-    clock_t timer;      // stores the clock values of the start/stop times
-    double  timeTaken;  // how long the algorithm took to execute
+    std::chrono::steady_clock::time_point timer;      // when the timer was started
+    std::chrono::steady_clock::time_point phaseStart; // when the current phase started
+    double timeTaken;                   // how long the algorithm took to execute (ms)
+    double phaseTimes[PHASE_COUNT];     // how long each phase took (ms)
+    long long counts[COUNTER_COUNT];    // the hardware counts of the task, -1 if not counted
+    long long allocs[ALLOC_STATS];      // the allocations of the task, -1 if not counted
 
 public:
     Memory();
@@ -17,6 +49,7 @@ public:
     // functions for funcCalls
     int  getFuncCalls();
     void incrFuncCalls();
+    void addFuncCalls(const int calls);
 
     // functions for timeTaken
     void   startTimer();
@@ -24,10 +57,36 @@ public:
     void   setTimeTaken(const double time);
     double getTimeTaken();
 
+    // functions for phaseTimes
+    void   startPhase();
+    void   endPhase(const int phase);
+    void   setPhaseTime(const int phase, const double time);
+    double getPhaseTime(const int phase);
+
+    // functions for counts
+    void      setCounts(const long long* values);
+    void      addCounts(const long long* values);
+    long long getCount(const int counter);
+    bool      hasCounts();
+
+    // functions for allocs
+    void      setAllocations(const long long* values);
+    long long getAllocation(const int stat);
+    bool      hasAllocations();
+
+    // functions for originalCmax
+    void setOriginalCmax(const int cmax);
+    int  getOriginalCmax();
+
+    // functions for the totals of a batch
+    void addTotals(Memory& task);
+    void writeBatchData(const long tasks, const double wallTime, const double cpuTime, OutputBuffer* out);
+
     // overall functions
-    void writeAllData(Matrix* jobs, Matrix* compTimes, Permutation* perm, const int alg, const int datafile);
-    void writeRawData(Matrix* jobTimes, Matrix* complTimes, Permutation* perm, const int alg, const int datafile);
-    void writeGanttData(Matrix* jobs, Matrix* compTimes, Permutation* perm, const int alg, const int datafile);
+    void writeAllData(Matrix* jobs, Matrix* compTimes, Permutation* perm, const int alg, const int datafile, const int gantt, OutputBuffer* out);
+    void writeRawData(Matrix* jobTimes, Matrix* complTimes, Permutation* perm, const int alg, const int datafile, OutputBuffer* out);
+    void writeGanttData(Matrix* jobs, Matrix* compTimes, Permutation* perm, const int alg, const int datafile, OutputBuffer* out);
+    void writeGanttBinary(Matrix* jobs, Matrix* compTimes, Permutation* perm, const int alg, const int datafile, OutputBuffer* out);
 
 };
 
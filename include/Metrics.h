@@ -0,0 +1,112 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "OutputBuffer.h"
+
+using namespace std;
+
+/*
+ * The latency histogram is log-linear, like an HDR histogram: every power
+ * of two of nanoseconds is split into 8 buckets, so a bucket is never more
+ * than 12.5% wide, from 1 ns to over an hour.
+ */
+const int METRIC_SUB_BITS = 3;
+const int METRIC_BUCKETS  = 320;
+const int METRIC_SIZES    = 6;      // instance sizes: up to 20, 50, 100, 200, 500 jobs, and more
+const int METRIC_THREADS  = 256;    // threads with their own counters, any more share the last
+const int METRIC_COUNTERS = 4;
+
+// the counters of every thread
+const int METRIC_EVALUATIONS = 0;   // makespan evaluations
+const int METRIC_TASKS       = 1;   // tasks completed
+const int METRIC_CACHED      = 2;   // tasks answered from the result cache
+const int METRIC_ABORTED     = 3;   // tasks lost with a crashed worker process
+
+// the counters and histograms of one thread, on cache lines of their own so
+// threads never write to the same line
+struct alignas(64) ThreadMetrics {
+    atomic<uint64_t> counters[METRIC_COUNTERS];
+    atomic<uint64_t> latency[METRIC_SIZES][METRIC_BUCKETS];
+};
+
+// the sum of every thread's metrics at one moment
+struct MetricsSnapshot {
+    uint64_t counters[METRIC_COUNTERS];
+    uint64_t latency[METRIC_SIZES][METRIC_BUCKETS];
+};
+
+/*
+ * Process wide metrics. Each thread counts into its own ThreadMetrics with
+ * relaxed atomic adds (no locks), and a reporter thread adds them up every
+ * few seconds, prints the rates, and writes a Prometheus text file.
+ */
+class Metrics {
+private:
+    static atomic<bool> enabled;            // whether anything is recorded
+    static atomic<int>  claimed;            // how many thread slots are in use
+    static atomic<ThreadMetrics*> slots[METRIC_THREADS];
+
+    string path;            // the Prometheus file, or empty for none
+    int    interval;        // seconds between reports
+    bool   done;            // set once the reporter should stop
+    vector< pair<string, function<size_t()> > > gauges;    // queue depths, sampled by the reporter
+
+    MetricsSnapshot last;   // the previous report, to work out rates
+    chrono::steady_clock::time_point lastTime;
+    chrono::steady_clock::time_point startTime;
+    OutputBuffer buffer;
+
+    mutex reportMutex;
+    condition_variable wake;
+    thread reporter;
+
+    static ThreadMetrics* forThread();
+
+    void run();
+    void report(const bool final);
+    void snapshot(MetricsSnapshot* snap);
+    void writeFile(MetricsSnapshot* snap, const double rate);
+
+public:
+    Metrics();
+    ~Metrics();
+
+    // functions for the batch
+    bool start(const string prometheus, const int seconds);
+    void addGauge(const string name, function<size_t()> sample);
+    void stop();
+    static void stopRecording();
+
+    // functions for the threads
+    static bool isEnabled();
+    static void count(const int counter);
+    static void recordEvaluation(const int jobs, const uint64_t nanos);
+
+    // functions for the histogram
+    static int      bucketOf(const uint64_t nanos);
+    static uint64_t bucketLimit(const int bucket);
+    static int      sizeOf(const int jobs);
+};
+
+/**
+ * @brief Returns whether metrics are being recorded. Kept inline so the
+ *          evaluation loop pays one load and branch when they are off.
+ *
+ * @return true If a reporter is running
+ */
+inline bool Metrics::isEnabled()
+{
+    return enabled.load(memory_order_relaxed);
+}
+
+#endif
@@ -0,0 +1,28 @@
+#ifndef OPTIONS_H
+#define OPTIONS_H
+
+#include <map>
+#include <string>
+
+using namespace std;
+
+class Options {
+private:
+    map<string, string> values;     // every "key value" pair read from the file
+
+public:
+    Options();
+
+    // functions for reading the options file
+    bool load(const string path);
+    void set(const string key, const string value);
+
+    // functions for retreiving values
+    bool   has(const string key);
+    string getString(const string key, const string fallback);
+    int    getInt(const string key, const int fallback);
+};
+
+Options* getOptions();
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef OUTPUT_BUFFER_H
+#define OUTPUT_BUFFER_H
+
+#include <cstddef>
+#include <vector>
+
+using namespace std;
+
+/*
+ * A reusable buffer that a whole output file is formatted into before it is
+ * written with a single write() call. Integers are converted by hand rather
+ * than through a stream, and the memory is kept between files, so once the
+ * buffer has grown to the largest file nothing more is allocated.
+ */
+class OutputBuffer {
+private:
+    vector<char> buf;   // the memory of the buffer, only ever grows
+    size_t len;         // how many bytes are in use
+
+    char* reserve(const size_t bytes);
+
+public:
+    OutputBuffer();
+
+    // functions for filling the buffer
+    void clear();
+    void putChar(const char c);
+    void putString(const char* str);
+    void putInt(const long long val);
+    void putDouble(const double val);
+    void putBytes(const void* bytes, const size_t count);
+    void align(const size_t boundary);
+
+    // functions for the contents
+    const char* data();
+    size_t size();
+    bool   writeFile(const char* pathname);
+    bool   writeTo(const int fd);
+
+    static char* formatInt(char* dst, long long val);
+};
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef PUBLISHER_H
+#define PUBLISHER_H
+
+#include <string>
+
+#include "Result.h"
+#include "Ring.h"
+
+using namespace std;
+
+// the writing end of the shared memory ring (see Ring.h). Only one thread
+// of one process may publish into a ring.
+class Publisher {
+private:
+    string name;        // the name of the segment
+    void*  mapping;     // the mapped segment
+    size_t size;        // the size of the mapping in bytes
+
+    RingHeader* header; // the header at the start of the segment
+    RingSlot*   slots;  // the slots after it
+    long published;     // how many records this batch published
+
+public:
+    Publisher();
+    ~Publisher();
+
+    bool open(const string segment, const int slotCount);
+    void publish(Result* res);
+    void close();
+    void report();
+};
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef RESULT_H
+#define RESULT_H
+
+#include <string>
+#include <vector>
+
+#include "Matrix.h"
+#include "Memory.h"
+
+using namespace std;
+
+// everything the writer needs to report one finished task
+struct Result {
+    int datafile;           // which datafile was optimized
+    int alg;                // which algorithm it was optimized with
+    int cmax;               // the makespan of the best sequence
+
+    Memory mem;             // the statistics recorded while optimizing
+    vector<int> sequence;   // the best job sequence (indices of jobs' columns)
+};
+
+string resultToLine(Result* res);
+bool   resultFromLine(const string line, Result* res);
+
+#endif
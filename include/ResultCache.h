@@ -0,0 +1,65 @@
+#ifndef RESULT_CACHE_H
+#define RESULT_CACHE_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <utility>
+
+#include "Matrix.h"
+#include "Result.h"
+
+using namespace std;
+
+/*
+ * A cache of finished results, one small file per result in the cache
+ * directory, named by a hash of the instance's contents, the algorithm, and
+ * the solver settings. A datafile that was solved before (under any number)
+ * is read back instead of solved again.
+ *
+ * The cache also keeps a manifest of the tasks the current batch finished.
+ * If the batch is stopped, the next batch with the same settings resumes
+ * from it, skipping those tasks without even reading their datafiles. The
+ * manifest is removed once a batch completes.
+ */
+class ResultCache {
+private:
+    string directory;       // where the results are kept
+    string settings;        // the solver settings that are part of every key
+    string manifestPath;    // the manifest of the current batch
+    int    manifest;        // the open manifest, or -1
+
+    map< pair<int, int>, uint64_t > finished;   // tasks of an interrupted batch, and their keys
+    set<uint64_t> running;  // keys being solved right now
+
+    long hits;              // results read back instead of solved
+    long misses;            // results that had to be solved
+    long resumed;           // tasks skipped because the manifest had them
+    long waits;             // tasks that waited for the same instance to be solved
+
+    mutex cacheMutex;
+    condition_variable solved;
+
+    string entryPath(const uint64_t key);
+    bool   readEntry(const uint64_t key, Result* res);
+    void   record(Result* res, const uint64_t key);
+
+public:
+    ResultCache(const string dir, const string solverSettings, const bool useManifest);
+    ~ResultCache();
+
+    // functions for the tasks
+    uint64_t makeKey(Matrix* jobs, const int alg);
+    bool acquire(const int datafile, const uint64_t key, Result* res);
+    void store(const uint64_t key, Result* res);
+
+    // functions for the batch
+    bool resume(const int datafile, const int alg, Result* res);
+    void complete();
+    void report();
+};
+
+#endif
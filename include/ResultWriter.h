@@ -0,0 +1,58 @@
+#ifndef RESULT_WRITER_H
+#define RESULT_WRITER_H
+
+#include <condition_variable>
+#include <mutex>
+#include <queue>
+#include <thread>
+
+#include "Bundle.h"
+#include "OutputBuffer.h"
+#include "Publisher.h"
+#include "Result.h"
+#include "Summary.h"
+
+using namespace std;
+
+class ResultWriter {
+private:
+    size_t capacity;        // how many records may wait before workers block
+    bool   done;            // set once no more records will be pushed
+    int    output;          // how much is written for each result (OUTPUT_*)
+    int    gantt;           // which Gantt files are written (GANTT_* flags)
+    Summary* summary;       // the table every result gets a row in, or nullptr
+    Publisher* publisher;   // where every result is published, or nullptr
+    Bundle* bundle;         // where instances are read again from, or nullptr for the datafiles
+
+    long   written;         // how many records have been written
+    long   waits;           // how many pushes had to wait for room
+    double waitTime;        // total time (ms) workers spent waiting for room
+    Memory totals;          // the function calls and times of every record
+
+    queue<Result*> records; // the records waiting to be written
+    OutputBuffer buffer;    // every file is formatted here, reused between files
+
+    mutex queueMutex;
+    condition_variable notEmpty;
+    condition_variable notFull;
+    thread writer;
+
+    void drain();
+    void write(Result* res);
+
+public:
+    ResultWriter(const size_t cap, Summary* table, Publisher* ring, Bundle* source);
+    ~ResultWriter();
+
+    // functions for the workers
+    void push(Result* res);
+
+    // functions for the batch
+    void finish();
+    void report();
+    long getWritten();
+    size_t queued();
+    Memory* getTotals();
+};
+
+#endif
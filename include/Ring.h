@@ -0,0 +1,200 @@
+#ifndef RING_H
+#define RING_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/*
+ * The shared memory ring that finished results are published into (see the
+ * publish option). One process writes, any number of local processes read.
+ *
+ * The segment is a 64 byte header followed by slotCount slots of
+ * RING_SLOT_SIZE bytes. Record n goes into slot n % slotCount. Each slot has
+ * a sequence number that is odd while the slot is being written and
+ * 2n + 2 once record n is in it, so a reader can tell a finished record from
+ * one being written or one already written over. The header's head is the
+ * number of records published so far, and its epoch tells batches apart.
+ *
+ * A segment is never resized while it is mapped. A new batch marks the old
+ * segment retired, unlinks its name, and creates a fresh segment under the
+ * same name, so a reader still mapped to the old one keeps valid memory; it
+ * reads what is left there, then reopens the name and follows the new batch.
+ *
+ * This header is also the reader: include it and use RingReader. Readers
+ * never write to the segment, so a slow reader can't hold up the solver; it
+ * just skips (and counts) the records it was too slow to see.
+ */
+const char     RING_MAGIC[4]  = { 'F', 'S', 'R', 'B' };
+const uint32_t RING_VERSION   = 2;
+const uint32_t RING_SLOT_SIZE = 4096;
+
+struct RingHeader {
+    char     magic[4];              // always RING_MAGIC
+    uint32_t version;               // the version of the format
+    uint32_t slotSize;              // the size of one slot in bytes
+    uint32_t slotCount;             // how many slots follow the header
+    uint64_t epoch;                 // differs for every batch
+    std::atomic<uint64_t> head;     // how many records have been published
+    std::atomic<uint64_t> retired;  // nonzero once a newer batch replaced the segment
+    uint64_t reserved[3];           // pads the header to 64 bytes
+};
+
+// one finished result, as it is published
+struct RingRecord {
+    int32_t  datafile;      // which datafile was optimized
+    int32_t  alg;           // which algorithm it was optimized with (1 FSS, 2 FSSB, 3 FSSNW)
+    int32_t  cmax;          // the makespan of the best sequence
+    int32_t  originalCmax;  // the makespan of the original order
+    int32_t  funcCalls;     // how many evaluations it took
+    uint32_t jobs;          // how many jobs the sequence has
+    uint32_t stored;        // how many of them fit in sequence (the first ones)
+    uint32_t reserved;      // keeps timeTaken aligned
+    double   timeTaken;     // how long it took (ms)
+    int32_t  sequence[(RING_SLOT_SIZE - 16 - 40) / 4];  // the job sequence (columns of the datafile)
+};
+
+struct RingSlot {
+    std::atomic<uint64_t> seq;  // 2n + 2 once record n is in the slot, odd while writing
+    uint64_t   reserved;        // keeps the record 16 byte aligned
+    RingRecord record;          // the record
+};
+
+static_assert(sizeof(RingHeader) == 64, "the ring header must be 64 bytes");
+static_assert(sizeof(RingSlot) == RING_SLOT_SIZE, "a ring slot must be RING_SLOT_SIZE bytes");
+
+const uint32_t RING_MAX_JOBS = sizeof(((RingRecord*)nullptr)->sequence) / sizeof(int32_t);
+
+// reads the records of a ring, from another process
+class RingReader {
+private:
+    std::string name;   // the name of the segment
+    void*  mapping;     // the mapped segment
+    size_t size;        // the size of the mapping in bytes
+
+    RingHeader* header; // the header at the start of the segment
+    RingSlot*   slots;  // the slots after it
+
+    uint64_t epoch;     // the epoch of the mapped segment
+    uint64_t cursor;    // the next record to read
+    uint64_t lost;      // records written over before they were read
+
+public:
+    RingReader() : mapping(nullptr), size(0), header(nullptr), slots(nullptr), epoch(0), cursor(0), lost(0) {}
+    ~RingReader() { close(); }
+
+    // maps a ring by its name (such as "/flowshop"). With fromStart the
+    // reader begins at the oldest record still in the ring, otherwise at the
+    // next one published. The mapping the reader has stays if this fails.
+    bool open(const std::string segment, const bool fromStart)
+    {
+        int fd = shm_open(segment.c_str(), O_RDONLY, 0);
+        if (fd < 0)
+            return false;
+
+        struct stat info;
+        size_t mappedSize = (fstat(fd, &info) == 0) ? info.st_size : 0;
+        void* mapped = (mappedSize >= sizeof(RingHeader)) ?
+            mmap(nullptr, mappedSize, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+        ::close(fd);
+
+        if (mapped == MAP_FAILED)
+            return false;
+
+        // the magic is written last, after everything else of the header
+        RingHeader* fresh = static_cast<RingHeader*>(mapped);
+        bool ready = memcmp(fresh->magic, RING_MAGIC, 4) == 0;
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        if (!ready || fresh->version != RING_VERSION || fresh->slotSize != RING_SLOT_SIZE ||
+            fresh->slotCount == 0 ||
+            sizeof(RingHeader) + (uint64_t)fresh->slotCount * RING_SLOT_SIZE > mappedSize)
+        {
+            munmap(mapped, mappedSize);
+            return false;
+        }
+
+        close();
+        name    = segment;
+        mapping = mapped;
+        size    = mappedSize;
+        header  = fresh;
+        slots   = reinterpret_cast<RingSlot*>(static_cast<char*>(mapping) + sizeof(RingHeader));
+
+        epoch = header->epoch;
+        uint64_t head = header->head.load(std::memory_order_acquire);
+        cursor = fromStart ? ((head > header->slotCount) ? head - header->slotCount : 0) : head;
+        return true;
+    }
+
+    void close()
+    {
+        if (mapping != nullptr)
+            munmap(mapping, size);
+
+        mapping = nullptr;
+        header  = nullptr;
+        slots   = nullptr;
+    }
+
+    bool     isOpen()   const { return mapping != nullptr; }
+    uint64_t getLost()  const { return lost; }
+    uint64_t getEpoch() const { return epoch; }
+
+    // copies the next record into out, returns false if there is none yet
+    bool next(RingRecord* out)
+    {
+        for (;;)
+        {
+            uint64_t head = header->head.load(std::memory_order_acquire);
+            if (cursor >= head)
+            {
+                // every record of a retired segment was read, follow the
+                // batch that replaced it from its first record
+                if (header->retired.load(std::memory_order_acquire) != 0 && open(name, true))
+                    continue;
+                return false;
+            }
+
+            // skip what was already written over
+            if (head - cursor > header->slotCount)
+            {
+                lost  += head - header->slotCount - cursor;
+                cursor = head - header->slotCount;
+            }
+
+            RingSlot& slot = slots[cursor % header->slotCount];
+            uint64_t before = slot.seq.load(std::memory_order_acquire);
+            if (before != 2 * cursor + 2)
+            {
+                if (before < 2 * cursor + 2)
+                    return false;   // still being written
+
+                ++lost;
+                ++cursor;
+                continue;
+            }
+
+            memcpy(out, &slot.record, sizeof(RingRecord));
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            // written over while copying
+            if (slot.seq.load(std::memory_order_relaxed) != before)
+            {
+                ++lost;
+                ++cursor;
+                continue;
+            }
+
+            ++cursor;
+            return true;
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,34 @@
+#ifndef SUMMARY_H
+#define SUMMARY_H
+
+#include <string>
+
+#include "OutputBuffer.h"
+#include "Result.h"
+
+using namespace std;
+
+// one CSV table for a whole batch, one row per (datafile, algorithm)
+class Summary {
+private:
+    int    fd;              // the open table, or -1
+    string pathname;        // where the table is
+    long   rows;            // how many rows have been added
+    bool   sequences;       // whether each row ends with the job sequence
+    bool   counts;          // whether each row has the hardware counts
+    bool   allocs;          // whether each row has the allocations
+    OutputBuffer buffer;    // rows waiting to be appended
+
+    void flush();
+
+public:
+    Summary();
+    ~Summary();
+
+    bool open(const string path, const bool withSequences, const bool withCounts, const bool withAllocs);
+    void add(Result* res);
+    void close();
+    void report();
+};
+
+#endif
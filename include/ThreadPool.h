@@ -18,6 +18,11 @@
  *      
  *      3. This notice may not be removed or altered from any source
  *      distribution.
+ *
+ *  Altered for this project: workers can run an init function with their
+ *  index before taking tasks (used to pin them to cpus), the number of
+ *  queued tasks can be read (used by the metrics reporter), and the queue
+ *  and the task states are allocated through CountingAllocator.
 */
 #ifndef THREAD_POOL_H
 #define THREAD_POOL_H
@@ -28,22 +33,28 @@
 #include <thread>
 #include <mutex>
 #include <condition_variable>
+#include <deque>
 #include <future>
 #include <functional>
 #include <stdexcept>
 
+#include "Allocations.h"
+
 class ThreadPool {
 public:
     ThreadPool(size_t);
+    ThreadPool(size_t, std::function<void(size_t)> init);
     template<class F, class... Args>
     auto enqueue(F&& f, Args&&... args) 
         -> std::future<typename std::result_of<F(Args...)>::type>;
+    size_t queued();
     ~ThreadPool();
 private:
     // need to keep track of threads so we can join them
     std::vector< std::thread > workers;
     // the task queue
-    std::queue< std::function<void()> > tasks;
+    std::queue< std::function<void()>,
+        std::deque< std::function<void()>, CountingAllocator< std::function<void()> > > > tasks;
     
     // synchronization
     std::mutex queue_mutex;
@@ -53,12 +64,21 @@ private:
  
 // the constructor just launches some amount of workers
 inline ThreadPool::ThreadPool(size_t threads)
+    :   ThreadPool(threads, std::function<void(size_t)>())
+{
+}
+
+// launches the workers, each of which runs init with its index first
+inline ThreadPool::ThreadPool(size_t threads, std::function<void(size_t)> init)
     :   stop(false)
 {
     for(size_t i = 0;i<threads;++i)
         workers.emplace_back(
-            [this]
+            [this, init, i]
             {
+                if(init)
+                    init(i);
+
                 for(;;)
                 {
                     std::function<void()> task;
@@ -86,7 +106,8 @@ auto ThreadPool::enqueue(F&& f, Args&&... args)
 {
     using return_type = typename std::result_of<F(Args...)>::type;
 
-    auto task = std::make_shared< std::packaged_task<return_type()> >(
+    auto task = std::allocate_shared< std::packaged_task<return_type()> >(
+            CountingAllocator< std::packaged_task<return_type()> >(),
             std::bind(std::forward<F>(f), std::forward<Args>(args)...)
         );
         
@@ -104,6 +125,13 @@ auto ThreadPool::enqueue(F&& f, Args&&... args)
     return res;
 }
 
+// the number of tasks waiting for a worker
+inline size_t ThreadPool::queued()
+{
+    std::unique_lock<std::mutex> lock(queue_mutex);
+    return tasks.size();
+}
+
 // the destructor joins all threads
 inline ThreadPool::~ThreadPool()
 {
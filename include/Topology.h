@@ -0,0 +1,54 @@
+#ifndef TOPOLOGY_H
+#define TOPOLOGY_H
+
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// the ways workers can be placed on the machine
+const int AFFINITY_NONE = 0;    // let the scheduler place the workers
+const int AFFINITY_NODE = 1;    // bind each worker to the cpus of one NUMA node
+const int AFFINITY_CORE = 2;    // pin one worker to each physical core
+const int AFFINITY_SMT  = 3;    // pin one worker to each hardware thread
+
+struct CpuInfo {
+    int cpu;        // the logical cpu number
+    int core;       // the physical core the cpu belongs to
+    int package;    // the socket the core belongs to
+    int node;       // the NUMA node the cpu belongs to
+};
+
+class Topology {
+private:
+    int mode;           // which AFFINITY_* mode the workers are placed with
+    int numPackages;    // how many sockets are available
+    int numNodes;       // how many NUMA nodes are available
+    int numCores;       // how many physical cores are available
+
+    vector<CpuInfo> cpus;               // every cpu this process may run on
+    vector< vector<int> > placement;    // the cpus each worker may run on
+
+    int readSysInt(const string path, const int fallback);
+
+public:
+    Topology();
+
+    // functions for the machine layout
+    void detect();
+    int  getNumCpus();
+    int  getNumCores();
+    int  getNumNodes();
+
+    // functions for worker placement
+    void   plan(const int affinity, const int threads);
+    size_t getNumWorkers();
+    void   pinWorker(const size_t worker);
+
+    // misc functions
+    void report();
+};
+
+int parseAffinity(const string name);
+
+#endif
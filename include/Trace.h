@@ -0,0 +1,127 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+const int TRACE_ARGS = 2;   // arguments an event can carry
+
+// one span of work on one thread
+struct TraceEvent {
+    const char* name;
+    const char* category;
+    uint64_t    start;      // ns since the trace started
+    uint64_t    duration;   // ns
+    const char* keys[TRACE_ARGS];
+    long long   values[TRACE_ARGS];
+};
+
+// the events of one thread, only ever added to by that thread
+struct TraceBuffer {
+    int    tid;
+    string name;
+    vector<TraceEvent> events;
+};
+
+/*
+ * Records what every thread of a batch is doing as spans (loads, NEH steps,
+ * blocks, writes, and the waits at the algorithm barriers), and writes them
+ * as Chrome trace event JSON, which chrome://tracing and Perfetto display as
+ * a timeline with a row for each thread. Each thread adds to its own buffer
+ * without locks, the buffers are only read once the batch is over.
+ */
+class Trace {
+private:
+    static atomic<bool> enabled;
+    static chrono::steady_clock::time_point epoch;
+
+public:
+    static bool start();
+    static void finish(const string path);
+    static void stopRecording();
+
+    static bool     isEnabled();
+    static uint64_t now();
+    static void     nameThread(const string name);
+    static void     record(const TraceEvent& event);
+};
+
+/*
+ * Traces the scope it is declared in. When tracing is off, the constructor
+ * and destructor only check a flag.
+ */
+class TraceScope {
+private:
+    bool active;
+    TraceEvent event;
+
+public:
+    TraceScope(const char* name, const char* category);
+    ~TraceScope();
+    void setArg(const int index, const char* key, const long long value);
+};
+
+/**
+ * @brief Returns whether events are being recorded
+ *
+ * @return true If a trace is running
+ */
+inline bool Trace::isEnabled()
+{
+    return enabled.load(memory_order_relaxed);
+}
+
+/**
+ * @brief Starts a span, if tracing is on
+ *
+ * @param name      What the span is, such as "load"
+ * @param category  The group it belongs to, such as "task"
+ */
+inline TraceScope::TraceScope(const char* name, const char* category)
+{
+    active = Trace::isEnabled();
+    if (!active)
+        return;
+
+    event.name     = name;
+    event.category = category;
+    event.keys[0]  = nullptr;
+    event.keys[1]  = nullptr;
+    event.start    = Trace::now();
+}
+
+/**
+ * @brief Ends the span and adds it to the thread's buffer
+ *
+ */
+inline TraceScope::~TraceScope()
+{
+    if (!active)
+        return;
+
+    event.duration = Trace::now() - event.start;
+    Trace::record(event);
+}
+
+/**
+ * @brief Attaches a number to the span, shown when it is selected
+ *
+ * @param index The argument slot (0 or 1)
+ * @param key   The name of the number
+ * @param value The number
+ */
+inline void TraceScope::setArg(const int index, const char* key, const long long value)
+{
+    if (!active)
+        return;
+
+    event.keys[index]   = key;
+    event.values[index] = value;
+}
+
+#endif
@@ -0,0 +1,34 @@
+#ifndef DECOMPOSE_H
+#define DECOMPOSE_H
+
+#include <string>
+#include <vector>
+
+#include "Matrix.h"
+#include "Memory.h"
+#include "Permutation.h"
+#include "ThreadPool.h"
+
+using namespace std;
+
+// the rules for splitting the jobs into blocks
+const int SPLIT_INDEX  = 0;     // consecutive job numbers
+const int SPLIT_COST   = 1;     // consecutive jobs of the NEH (total work) order
+const int SPLIT_STRIDE = 2;     // every k-th job of the NEH order, so blocks are alike
+
+int parseSplitRule(const string name);
+
+int decompose(Matrix* jobs, Memory* mem, const int alg, ThreadPool* tp, const int blockSize,
+              const int rule, const int radius, vector<int>& sequence);
+
+vector< vector<int> > splitJobs(Matrix* jobs, const int blockSize, const int rule);
+
+int solveBlock(Matrix* jobs, const vector<int>& block, Memory* mem, const int alg, vector<int>& sequence);
+int repairBoundary(Matrix* jobs, const int alg, const int lo, const int hi, Memory* mem, vector<int>& sequence);
+int evalSequence(Matrix* jobs, const int alg, const vector<int>& sequence, const int first, const int last);
+int evaluateFrom(Matrix* jobs, Matrix* comp, Permutation* perm, const int alg, const int lo,
+                 const int hi, vector<int>& saved, int& shift);
+void shiftColumns(Matrix* comp, const int first, const int last, const int shift);
+void restoreColumns(Matrix* comp, const int lo, const int last, const vector<int>& saved);
+
+#endif
@@ -2,14 +2,24 @@
 #ifndef FLOWSHOP_H
 #define FLOWSHOP_H
 
+#include <vector>
+
+#include "Batch.h"
+#include "Bundle.h"
+#include "Publisher.h"
+#include "ResultCache.h"
 #include "Matrix.h"
 #include "Memory.h"
 #include "Permutation.h"
+#include "Result.h"
 
 void run();
+void runBatch();
 void runFlowshop();
 void runCustomPermutation();
-int  flowshop(const int datafile, const int alg);
+int  flowshop(const int datafile, const int alg, Batch* batch);
+Result* solve(const int datafile, const int alg, Batch* batch);
+int  neh(Matrix* jobs, Matrix* comp, Permutation* perm, Memory* mem, const int alg);
 
 int fssType    (Matrix* jobs, Matrix* comp, const int alg);
 int fssTypePerm(Matrix* jobs, Matrix* comp, Permutation* perm, const int alg);
@@ -35,5 +45,11 @@ int newTimeFSSNWPerm(Matrix* jobs, Matrix* compTime, Permutation* perm, const in
 
 void initialize(Matrix* jobTimes, Permutation* perm);
 void initParameters(int &start, int &end, int &algStart, int &algEnd);
+bool openBundle(Bundle* bundle);
+ResultCache* openCache(const bool useManifest);
+bool openPublisher(Publisher* publisher);
+std::vector<int> selectDatafiles(const int start, const int end, Bundle* bundle);
+double cpuTime();
+void reportBatch(const long tasks, const double wallTime, const double cpuTime, Memory* totals);
 
 #endif
@@ -0,0 +1,29 @@
+#ifndef WAVEFRONT_H
+#define WAVEFRONT_H
+
+#include "Matrix.h"
+#include "Permutation.h"
+#include "ThreadPool.h"
+
+// default tile size, roughly a 256KB slice of the completion matrix
+const int WAVE_TILE_ROWS = 32;
+const int WAVE_TILE_COLS = 2048;
+
+// bounds on the side of the square FSSB tiles, see fssbTileSide()
+const int WAVE_FSSB_TILE_MIN = 8;
+const int WAVE_FSSB_TILE_MAX = 64;
+
+int fssWavefront (Matrix* jobTimes, Matrix* compTimes, Permutation* perm, ThreadPool* tp,
+                  const int tileRows, const int tileCols);
+int fssbWavefront(Matrix* jobTimes, Matrix* compTimes, Permutation* perm, ThreadPool* tp,
+                  const int tileRows, const int tileCols);
+
+int fssbTileSide(const int machines, const int threads);
+double waveWidth(const int tileRows, const int tileCols, const int rows, const int cols, const bool skewed);
+
+void fssTile (Matrix* jobTimes, Matrix* compTimes, const int* order, const int r0, const int r1,
+              const int c0, const int c1);
+void fssbTile(Matrix* jobTimes, Matrix* compTimes, const int* order, const int r0, const int r1,
+              const int c0, const int c1);
+
+#endif
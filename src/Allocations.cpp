@@ -0,0 +1,211 @@
+/**
+ * @file Allocations.cpp
+ * @author Matthew Harker
+ * @brief Counts the memory the batch allocates: the allocations, bytes, and
+ *          peak bytes of every task, the bytes still live in the whole
+ *          process, and the resident size of the process.
+ * @version 1.0
+ * @date 2019-06-20
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sys/resource.h>
+
+#include "Allocations.h"
+
+using namespace std;
+
+const char* ALLOC_NAMES[ALLOC_STATS] = { "allocations", "alloc_bytes", "peak_bytes", "rss_kb" };
+
+atomic<long long> Allocations::blocks(0);
+atomic<long long> Allocations::bytes(0);
+atomic<long long> Allocations::live(0);
+atomic<long long> Allocations::peak(0);
+
+// the numbers of the task the thread is running. live can go below zero
+// when the task frees something another thread allocated.
+struct TaskAllocations {
+    long long blocks;
+    long long bytes;
+    long long live;
+    long long peak;
+};
+
+static thread_local TaskAllocations task = { 0, 0, 0, 0 };
+
+/**
+ * @brief Counts an allocation on the calling thread and in the process
+ *
+ * @param size The bytes allocated
+ */
+void Allocations::counted(const size_t size)
+{
+    ++task.blocks;
+    task.bytes += size;
+    task.live  += size;
+    task.peak   = max(task.peak, task.live);
+
+    blocks.fetch_add(1, memory_order_relaxed);
+    bytes.fetch_add(size, memory_order_relaxed);
+
+    // raise the peak of the process if this is the most ever live
+    long long now = live.fetch_add(size, memory_order_relaxed) + size;
+    long long most = peak.load(memory_order_relaxed);
+    while (now > most && !peak.compare_exchange_weak(most, now, memory_order_relaxed))
+        ;
+}
+
+/**
+ * @brief Counts a free on the calling thread and in the process
+ *
+ * @param size The bytes freed
+ */
+void Allocations::freed(const size_t size)
+{
+    task.live -= size;
+    live.fetch_sub(size, memory_order_relaxed);
+}
+
+/**
+ * @brief Counts blocks another thread allocated as allocated by the task of
+ *          the calling thread, such as an instance read ahead for it. The
+ *          process totals already have them.
+ *
+ * @param count How many blocks
+ * @param size  How many bytes they hold
+ */
+void Allocations::adopt(const long long count, const long long size)
+{
+    task.blocks += count;
+    task.bytes  += size;
+    task.live   += size;
+    task.peak    = max(task.peak, task.live);
+}
+
+/**
+ * @brief Starts counting a new task on the calling thread
+ *
+ */
+void Allocations::beginTask()
+{
+    task.blocks = 0;
+    task.bytes  = 0;
+    task.live   = 0;
+    task.peak   = 0;
+}
+
+/**
+ * @brief Returns the numbers of the task the calling thread ran
+ *
+ * @param stats Receives each ALLOC_* statistic
+ */
+void Allocations::endTask(long long* stats)
+{
+    stats[ALLOC_COUNT] = task.blocks;
+    stats[ALLOC_BYTES] = task.bytes;
+    stats[ALLOC_PEAK]  = task.peak;
+    stats[ALLOC_RSS]   = residentKB();
+}
+
+/**
+ * @brief Returns the bytes allocated and not yet freed
+ *
+ * @return long long The live bytes of the process
+ */
+long long Allocations::getLive()
+{
+    return live.load();
+}
+
+/**
+ * @brief Returns the most bytes that were ever live at once
+ *
+ * @return long long The peak bytes of the process
+ */
+long long Allocations::getPeak()
+{
+    return peak.load();
+}
+
+/**
+ * @brief Returns how many allocations were made
+ *
+ * @return long long The allocations of the process
+ */
+long long Allocations::getBlocks()
+{
+    return blocks.load();
+}
+
+/**
+ * @brief Returns how many bytes were allocated
+ *
+ * @return long long The bytes of the process
+ */
+long long Allocations::getBytes()
+{
+    return bytes.load();
+}
+
+/**
+ * @brief Reads one "Name: value kB" line of /proc/self/status
+ *
+ * @param field         The name, such as "VmRSS"
+ * @return long long    The value (kB), or -1 if it is not there
+ */
+static long long readStatus(const char* field)
+{
+    FILE* status = fopen("/proc/self/status", "r");
+    if (status == nullptr)
+        return -1;
+
+    char line[256];
+    long long value = -1;
+    size_t length = strlen(field);
+    while (fgets(line, sizeof(line), status) != nullptr)
+    {
+        if (strncmp(line, field, length) == 0 && line[length] == ':')
+        {
+            value = atoll(line + length + 1);
+            break;
+        }
+    }
+    fclose(status);
+
+    return value;
+}
+
+/**
+ * @brief Returns the resident size of the process
+ *
+ * @return long long The resident size (kB), or -1 if it is not known
+ */
+long long Allocations::residentKB()
+{
+    return readStatus("VmRSS");
+}
+
+/**
+ * @brief Returns the most the process was ever resident. The kernel's own
+ *          high-water mark is used when there is one, since getrusage()
+ *          only updates it now and then.
+ *
+ * @return long long The resident high-water mark (kB)
+ */
+long long Allocations::peakResidentKB()
+{
+    long long hwm = readStatus("VmHWM");
+    if (hwm >= 0)
+        return hwm;
+
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return -1;
+
+    return usage.ru_maxrss;
+}
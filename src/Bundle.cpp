@@ -0,0 +1,305 @@
+/**
+ * @file Bundle.cpp
+ * @author Matthew Harker
+ * @brief Reads and writes instance bundles, single files that hold a whole
+ *          suite of instances along with an index. A bundle is mapped once
+ *          and shared by every worker, instead of opening one small file
+ *          per instance per algorithm.
+ * @version 1.0
+ * @date 2019-06-09
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <functional>
+#include <iostream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "Bundle.h"
+
+using namespace std;
+
+/**
+ * @brief Construct a new Bundle:: Bundle object
+ *
+ */
+Bundle::Bundle()
+{
+    mapping = nullptr;
+    size    = 0;
+    header  = nullptr;
+    entries = nullptr;
+}
+
+/**
+ * @brief Destroy the Bundle:: Bundle object. Every Matrix made from the
+ *          bundle must be deleted first.
+ *
+ */
+Bundle::~Bundle()
+{
+    if (mapping != nullptr)
+        munmap(mapping, size);
+}
+
+/**
+ * @brief Maps a bundle file and checks its header and index
+ *
+ * @param pathname  The bundle file
+ * @return true     If the bundle can be used
+ */
+bool Bundle::open(const string pathname)
+{
+    int fd = ::open(pathname.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        cout << "Bundle " << pathname << " could not be found\n";
+        return false;
+    }
+
+    struct stat info;
+    size = (fstat(fd, &info) == 0) ? info.st_size : 0;
+
+    void* mapped = (size > 0) ? mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+    close(fd);
+
+    if (mapped == MAP_FAILED)
+    {
+        cout << "Bundle " << pathname << " is empty or could not be read\n";
+        return false;
+    }
+    mapping = mapped;
+
+    // check the header
+    header = static_cast<const BundleHeader*>(mapping);
+    if (size < sizeof(BundleHeader) || memcmp(header->magic, BUNDLE_MAGIC, 4) != 0 ||
+        header->version != BUNDLE_VERSION || header->width != sizeof(int) ||
+        header->indexOffset + (uint64_t)header->count * sizeof(BundleEntry) > size)
+    {
+        cout << "Bundle " << pathname << " is not a bundle this program can read\n";
+        munmap(mapping, size);
+        mapping = nullptr;
+        return false;
+    }
+
+    // check that every instance lies inside the file
+    entries = reinterpret_cast<const BundleEntry*>(static_cast<char*>(mapping) + header->indexOffset);
+    for (uint32_t i = 0; i < header->count; ++i)
+    {
+        uint64_t bytes = (uint64_t)entries[i].rows * entries[i].cols * sizeof(int);
+        if (entries[i].offset % sizeof(int) != 0 || entries[i].offset + bytes > size)
+        {
+            cout << "Bundle " << pathname << " has a damaged index\n";
+            munmap(mapping, size);
+            mapping = nullptr;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Returns whether a bundle is open
+ *
+ * @return true If a bundle is mapped
+ */
+bool Bundle::isOpen()
+{
+    return mapping != nullptr;
+}
+
+/**
+ * @brief Returns how many instances the bundle holds
+ *
+ * @return int The number of instances
+ */
+int Bundle::getCount()
+{
+    return isOpen() ? header->count : 0;
+}
+
+/**
+ * @brief Returns an entry of the index
+ *
+ * @param elem                  The position in the index
+ * @return const BundleEntry*   The entry
+ */
+const BundleEntry* Bundle::getEntry(const int elem)
+{
+    return &entries[elem];
+}
+
+/**
+ * @brief Finds the entry of a datafile. The index is sorted by id.
+ *
+ * @param id                    The datafile number
+ * @return const BundleEntry*   The entry, or nullptr if it is not in the bundle
+ */
+const BundleEntry* Bundle::find(const int id)
+{
+    if (!isOpen())
+        return nullptr;
+
+    const BundleEntry* end = entries + header->count;
+    const BundleEntry* it  = lower_bound(entries, end, id,
+        [](const BundleEntry& e, const int val) { return (int)e.id < val; });
+
+    return (it != end && (int)it->id == id) ? it : nullptr;
+}
+
+/**
+ * @brief Lists the datafiles in an id range, optionally only those with a tag
+ *
+ * @param first         The first datafile number
+ * @param last          The last datafile number
+ * @param tag           Only instances with this tag, or every one if empty
+ * @return vector<int>  The selected datafile numbers, in order
+ */
+vector<int> Bundle::select(const int first, const int last, const string tag)
+{
+    vector<int> ids;
+
+    for (int i = 0; i < getCount(); ++i)
+    {
+        int id = entries[i].id;
+        if (id < first || id > last)
+            continue;
+
+        string entryTag(entries[i].tag, strnlen(entries[i].tag, BUNDLE_TAG_SIZE));
+        if (!tag.empty() && entryTag != tag)
+            continue;
+
+        ids.push_back(id);
+    }
+
+    return ids;
+}
+
+/**
+ * @brief Returns a read-only view of one instance
+ *
+ * @param id        The datafile number
+ * @return Matrix*  A view of the instance, or nullptr if it is not in the bundle
+ */
+Matrix* Bundle::getMatrix(const int id)
+{
+    const BundleEntry* entry = find(id);
+    if (entry == nullptr)
+        return nullptr;
+
+    const int* values = reinterpret_cast<const int*>(static_cast<char*>(mapping) + entry->offset);
+    return new Matrix(values, entry->rows, entry->cols);
+}
+
+/**
+ * @brief Writes a bundle
+ *
+ * @param pathname  The bundle file to write
+ * @param ids       The datafile numbers to pack
+ * @param tags      The tag of each datafile (an empty tag uses "<rows>x<cols>")
+ * @param instance  Returns the matrix of the i-th datafile
+ * @param owned     Whether each matrix is freed once it is written
+ * @return true     If the whole bundle was written
+ */
+static bool packInstances(const string pathname, const vector<int>& ids, const vector<string>& tags,
+                          function<Matrix*(size_t)> instance, const bool owned)
+{
+    FILE* file = fopen(pathname.c_str(), "wb");
+    if (file == nullptr)
+        return false;
+
+    // the index is sorted by id so entries can be found by binary search
+    vector<size_t> order(ids.size());
+    for (size_t i = 0; i < order.size(); ++i)
+        order[i] = i;
+    sort(order.begin(), order.end(), [&ids](size_t a, size_t b) { return ids[a] < ids[b]; });
+
+    BundleHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, BUNDLE_MAGIC, 4);
+    header.version = BUNDLE_VERSION;
+    header.count   = ids.size();
+    header.width   = sizeof(int);
+
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+    uint64_t pos = sizeof(header);
+
+    // write each instance on a 64 byte boundary
+    vector<BundleEntry> index;
+    const char zeros[64] = { 0 };
+    for (size_t k = 0; k < order.size() && ok; ++k)
+    {
+        size_t i = order[k];
+        Matrix* jobs = instance(i);
+
+        size_t pad = (64 - pos % 64) % 64;
+        ok  = fwrite(zeros, 1, pad, file) == pad;
+        pos += pad;
+
+        BundleEntry entry;
+        memset(&entry, 0, sizeof(entry));
+        entry.id     = ids[i];
+        entry.rows   = jobs->getRows();
+        entry.cols   = jobs->getCols();
+        entry.offset = pos;
+
+        string tag = (i < tags.size() && !tags[i].empty()) ? tags[i]
+                   : to_string(jobs->getRows()) + "x" + to_string(jobs->getCols());
+        strncpy(entry.tag, tag.c_str(), BUNDLE_TAG_SIZE);
+        index.push_back(entry);
+
+        for (int r = 0; r < jobs->getRows() && ok; ++r)
+            ok = fwrite(jobs->getRow(r), sizeof(int), jobs->getCols(), file) == (size_t)jobs->getCols();
+        pos += (uint64_t)jobs->getRows() * jobs->getCols() * sizeof(int);
+
+        if (owned)
+            delete jobs;
+    }
+
+    // the index goes at the end, then the header is written again with its offset
+    size_t pad = (8 - pos % 8) % 8;
+    ok = ok && fwrite(zeros, 1, pad, file) == pad;
+    header.indexOffset = pos + pad;
+
+    ok = ok && fwrite(index.data(), sizeof(BundleEntry), index.size(), file) == index.size();
+    ok = ok && fseek(file, 0, SEEK_SET) == 0;
+    ok = ok && fwrite(&header, sizeof(header), 1, file) == 1;
+
+    return (fclose(file) == 0) && ok;
+}
+
+/**
+ * @brief Packs datafiles into a bundle
+ *
+ * @param pathname  The bundle file to write
+ * @param ids       The datafile numbers to pack
+ * @param tags      The tag of each datafile (an empty tag uses "<rows>x<cols>")
+ * @return true     If the whole bundle was written
+ */
+bool writeBundle(const string pathname, const vector<int>& ids, const vector<string>& tags)
+{
+    return packInstances(pathname, ids, tags, [&ids](size_t i) { return new Matrix(ids[i]); }, true);
+}
+
+/**
+ * @brief Packs instances already in memory into a bundle, such as generated
+ *          ones, under made up datafile numbers
+ *
+ * @param pathname  The bundle file to write
+ * @param ids       The number each instance is found by
+ * @param instances The instances, left as they are
+ * @param tags      The tag of each instance (an empty tag uses "<rows>x<cols>")
+ * @return true     If the whole bundle was written
+ */
+bool writeBundle(const string pathname, const vector<int>& ids, const vector<Matrix*>& instances,
+                 const vector<string>& tags)
+{
+    return packInstances(pathname, ids, tags, [&instances](size_t i) { return instances[i]; }, false);
+}
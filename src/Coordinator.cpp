@@ -0,0 +1,481 @@
+/**
+ * @file Coordinator.cpp
+ * @author Matthew Harker
+ * @brief Runs the batch over several worker processes. The coordinator
+ *          forks the workers, hands out one task at a time, and collects
+ *          the result records. A worker that dies (for example from a bad
+ *          datafile) is replaced and its task is handed out again, up to
+ *          a retry limit, so one bad file no longer ends the whole batch.
+ * @version 1.0
+ * @date 2019-06-07
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <deque>
+#include <iostream>
+#include <map>
+#include <poll.h>
+#include <sstream>
+#include <string>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+#include "Batch.h"
+#include "Bundle.h"
+#include "Coordinator.h"
+#include "flowshop.h"
+#include "Metrics.h"
+#include "Options.h"
+#include "Result.h"
+#include "Summary.h"
+#include "Topology.h"
+#include "Trace.h"
+
+using namespace std;
+
+// what the coordinator knows about one worker process
+struct WorkerProc {
+    int   index;        // which worker slot this process fills
+    pid_t pid;          // the process id of the worker
+    int   fd;           // the coordinator's end of the socket
+    bool  busy;         // whether the worker is running a task
+    int   datafile;     // the datafile of the running task
+    int   alg;          // the algorithm of the running task
+    string buffer;      // bytes read that do not form a full line yet
+};
+
+/**
+ * @brief Takes the first full line out of a buffer
+ *
+ * @param buffer    The bytes read so far
+ * @param line      Receives the line, without the newline
+ * @return true     If there was a full line
+ */
+static bool takeLine(string& buffer, string& line)
+{
+    size_t end = buffer.find('\n');
+    if (end == string::npos)
+        return false;
+
+    line = buffer.substr(0, end);
+    buffer.erase(0, end + 1);
+    return true;
+}
+
+/**
+ * @brief Reads the next line from a socket, waiting for it if needed
+ *
+ * @param fd        The socket to read from
+ * @param buffer    Bytes read earlier that did not form a full line
+ * @param line      Receives the line, without the newline
+ * @return true     If a line was read, false on end of file or error
+ */
+bool readLine(const int fd, string& buffer, string& line)
+{
+    char chunk[4096];
+
+    while (!takeLine(buffer, line))
+    {
+        ssize_t n = read(fd, chunk, sizeof(chunk));
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+
+        buffer.append(chunk, n);
+    }
+
+    return true;
+}
+
+/**
+ * @brief Writes one line to a socket
+ *
+ * @param fd    The socket to write to
+ * @param line  The line, without the newline
+ * @return true If the whole line was written
+ */
+bool writeLine(const int fd, const string line)
+{
+    string msg = line + "\n";
+    size_t done = 0;
+
+    while (done < msg.size())
+    {
+        ssize_t n = write(fd, msg.data() + done, msg.size() - done);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+
+        done += n;
+    }
+
+    return true;
+}
+
+/**
+ * @brief The loop of a worker process. Runs every task it is handed and
+ *          answers with the result record, until told to quit.
+ *
+ * @param fd The socket connected to the coordinator
+ */
+void serveWorker(const int fd)
+{
+    // a worker has its own writer, and one pool thread to help decompose.
+    // The coordinator keeps the summary and publishes, so the worker's writer does neither.
+    ThreadPool tp(1);
+    Bundle bundle;
+    bool useBundle = openBundle(&bundle);
+    ResultWriter writer(2, nullptr, nullptr, useBundle ? &bundle : nullptr);
+
+    Batch batch;
+    batch.pool   = &tp;
+    batch.writer = &writer;
+    batch.bundle = useBundle ? &bundle : nullptr;
+    batch.loader = nullptr;
+    batch.counting = getOptions()->getString("counters", "off") == "on";
+    batch.accounting = getOptions()->getString("allocations", "off") == "on";
+
+    // the workers share the cache's entries, but not a manifest
+    batch.cache  = openCache(false);
+
+    writeLine(fd, "HELLO " + to_string(getpid()));
+
+    string buffer, line;
+    while (readLine(fd, buffer, line))
+    {
+        istringstream iss(line);
+        string cmd;
+        iss >> cmd;
+
+        if (cmd == "QUIT")
+            break;
+
+        if (cmd == "TASK")
+        {
+            int datafile, alg;
+            iss >> datafile >> alg;
+
+            Result* res = solve(datafile, alg, &batch);
+            string record = "RESULT " + resultToLine(res);
+            writer.push(res);
+
+            if (!writeLine(fd, record))
+                break;
+        }
+    }
+
+    writer.finish();
+    delete batch.cache;
+}
+
+/**
+ * @brief Forks a new worker process
+ *
+ * @param index     The worker slot the process fills
+ * @param workers   The other workers, whose sockets the child closes
+ * @param topo      The placement plan of the workers
+ * @return WorkerProc The new worker (pid of -1 if the fork failed)
+ */
+static WorkerProc spawnWorker(const int index, vector<WorkerProc>& workers, Topology* topo)
+{
+    WorkerProc proc;
+    proc.index = index;
+    proc.pid   = -1;
+    proc.fd    = -1;
+    proc.busy  = false;
+
+    int sv[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) != 0)
+        return proc;
+
+    // don't let the child repeat anything still buffered
+    cout.flush();
+
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        // the child only keeps its own end of its own socket
+        close(sv[0]);
+        for (size_t w = 0; w < workers.size(); ++w)
+            if (workers[w].fd >= 0)
+                close(workers[w].fd);
+
+        // the coordinator keeps the metrics, the child's copy is never read
+        Metrics::stopRecording();
+        Trace::stopRecording();
+
+        topo->pinWorker(index);
+        serveWorker(sv[1]);
+
+        close(sv[1]);
+        _exit(0);
+    }
+
+    close(sv[1]);
+    if (pid < 0)
+    {
+        close(sv[0]);
+        return proc;
+    }
+
+    proc.pid = pid;
+    proc.fd  = sv[0];
+    return proc;
+}
+
+/**
+ * @brief Describes how a worker process ended
+ *
+ * @param status    The status from waitpid()
+ * @return string   A short description
+ */
+static string describeExit(const int status)
+{
+    if (WIFSIGNALED(status)) return "killed by signal " + to_string(WTERMSIG(status));
+    if (WIFEXITED(status))   return "exited with code " + to_string(WEXITSTATUS(status));
+    return "ended";
+}
+
+/**
+ * @brief Prints that every task of an algorithm is done
+ *
+ * @param alg The algorithm that completed
+ */
+static void announce(const int alg)
+{
+    if      (alg == 1) cout << "FSS has completed\n";
+    else if (alg == 2) cout << "FSSB has completed\n";
+    else if (alg == 3) cout << "FSSNW has completed\n";
+}
+
+/**
+ * @brief Runs the datasets in parameters.txt over several worker processes
+ *
+ * @param processes How many worker processes to use
+ */
+void runCoordinator(const int processes)
+{
+    // a worker dying mid-write must not take the coordinator with it
+    signal(SIGPIPE, SIG_IGN);
+
+    // the batch is timed by the wall clock and by the CPU time of every process
+    chrono::steady_clock::time_point batchStart = chrono::steady_clock::now();
+    double cpuStart = cpuTime();
+
+    int maxRetries = getOptions()->getInt("retries", 2);
+
+    // list every task, one algorithm after the other
+    int start, end, algStart, algEnd;
+    initParameters(start, end, algStart, algEnd);
+
+    // the coordinator only reads the bundle's index, each worker maps it itself
+    Bundle bundle;
+    bool useBundle = openBundle(&bundle);
+    vector<int> datafiles = selectDatafiles(start, end, useBundle ? &bundle : nullptr);
+
+    deque< pair<int, int> > pending;
+    for (int i = algStart; i <= algEnd; ++i)
+        for (size_t j = 0; j < datafiles.size(); ++j)
+            pending.push_back(make_pair(datafiles[j], i));
+
+    size_t total = pending.size();
+    map< pair<int, int>, int > attempts;
+    map<int, int> remaining;    // tasks left for each algorithm
+    for (size_t t = 0; t < pending.size(); ++t)
+        ++remaining[pending[t].second];
+
+    // place the workers the same way the thread pool places its threads
+    Topology topo;
+    topo.detect();
+    topo.plan(parseAffinity(getOptions()->getString("affinity", "none")), processes);
+
+    cout << "Coordinator: " << total << " task(s) over " << processes << " worker process(es)\n";
+
+    vector<WorkerProc> workers;
+    for (int w = 0; w < processes; ++w)
+    {
+        WorkerProc proc = spawnWorker(w, workers, &topo);
+        if (proc.pid > 0)
+            workers.push_back(proc);
+    }
+
+    if (workers.empty())
+    {
+        cout << "Could not start any worker processes, exiting program\n";
+        exit(EXIT_FAILURE);
+    }
+
+    // every result record that comes back gets a row in the summary
+    Summary summary;
+    string summaryPath = getOptions()->getString("summary", "results/summary.csv");
+    int output = parseOutputLevel(getOptions()->getString("output", "summary"));
+    bool counting = getOptions()->getString("counters", "off") == "on";
+    bool accounting = getOptions()->getString("allocations", "off") == "on";
+    bool useSummary = summaryPath != "none" && summary.open(summaryPath, output >= OUTPUT_SCHEDULE, counting, accounting);
+
+    Publisher publisher;
+    bool usePublisher = openPublisher(&publisher);
+
+    size_t finished = 0, failed = 0, reassigned = 0;
+    Memory totals;
+
+    // the coordinator counts the tasks that come back and the ones lost with
+    // a worker, the evaluations happen in the workers and are not counted
+    Metrics metrics;
+    atomic<size_t> waiting(pending.size());
+    metrics.addGauge("pending", [&waiting] { return waiting.load(); });
+    metrics.start(getOptions()->getString("metrics", "none"), getOptions()->getInt("metricsinterval", 5));
+
+    while (finished + failed < total && !workers.empty())
+    {
+        // hand a task to every idle worker
+        for (size_t w = 0; w < workers.size(); ++w)
+        {
+            if (workers[w].busy || pending.empty())
+                continue;
+
+            workers[w].datafile = pending.front().first;
+            workers[w].alg      = pending.front().second;
+            pending.pop_front();
+            workers[w].busy = true;
+
+            // if it can't be sent, the worker is found dead below
+            writeLine(workers[w].fd, "TASK " + to_string(workers[w].datafile) + " " + to_string(workers[w].alg));
+        }
+
+        waiting = pending.size();
+
+        // wait for any worker to answer (or die)
+        vector<pollfd> fds(workers.size());
+        for (size_t w = 0; w < workers.size(); ++w)
+        {
+            fds[w].fd      = workers[w].fd;
+            fds[w].events  = POLLIN;
+            fds[w].revents = 0;
+        }
+
+        if (poll(fds.data(), fds.size(), -1) < 0)
+        {
+            if (errno == EINTR) continue;
+            break;
+        }
+
+        for (size_t w = workers.size(); w-- > 0; )
+        {
+            if (fds[w].revents == 0)
+                continue;
+
+            WorkerProc& proc = workers[w];
+
+            char chunk[4096];
+            ssize_t n = read(proc.fd, chunk, sizeof(chunk));
+            if (n < 0 && errno == EINTR)
+                continue;
+
+            if (n > 0)
+            {
+                proc.buffer.append(chunk, n);
+
+                string line;
+                while (takeLine(proc.buffer, line))
+                {
+                    if (line.compare(0, 7, "RESULT ") != 0)
+                        continue;
+
+                    Result* res = new Result();
+                    if (resultFromLine(line.substr(7), res))
+                    {
+                        summary.add(res);
+                        publisher.publish(res);
+                        totals.addTotals(res->mem);
+                        ++finished;
+                        Metrics::count(METRIC_TASKS);
+                        if (--remaining[res->alg] == 0)
+                            announce(res->alg);
+                    }
+                    delete res;
+                    proc.busy = false;
+                }
+                continue;
+            }
+
+            // the worker is gone, find out why
+            int status = 0;
+            close(proc.fd);
+            waitpid(proc.pid, &status, 0);
+
+            cout << "Worker " << proc.pid << " " << describeExit(status);
+            if (proc.busy)
+            {
+                pair<int, int> task = make_pair(proc.datafile, proc.alg);
+                cout << " while running datafile " << task.first << " (algorithm " << task.second << ")";
+                Metrics::count(METRIC_ABORTED);
+
+                // give the task to another worker, unless it keeps failing
+                if (++attempts[task] <= maxRetries)
+                {
+                    pending.push_front(task);
+                    ++reassigned;
+                    cout << ", reassigning it";
+                }
+                else
+                {
+                    ++failed;
+                    cout << ", giving up on it";
+                }
+            }
+            cout << "\n";
+
+            if (proc.busy && attempts[make_pair(proc.datafile, proc.alg)] > maxRetries)
+                if (--remaining[proc.alg] == 0)
+                    announce(proc.alg);
+
+            // replace the worker while there is still work to do
+            int index = proc.index;
+            workers.erase(workers.begin() + w);
+            if (!pending.empty())
+            {
+                WorkerProc fresh = spawnWorker(index, workers, &topo);
+                if (fresh.pid > 0)
+                    workers.push_back(fresh);
+            }
+        }
+    }
+
+    // let the workers finish writing and leave
+    for (size_t w = 0; w < workers.size(); ++w)
+    {
+        writeLine(workers[w].fd, "QUIT");
+        close(workers[w].fd);
+    }
+    for (size_t w = 0; w < workers.size(); ++w)
+        waitpid(workers[w].pid, nullptr, 0);
+
+    metrics.stop();
+
+    cout << "Coordinator: " << finished << " finished, " << failed << " failed, ";
+    cout << reassigned << " reassigned\n";
+
+    // the CPU time includes every worker process, they have all been waited for
+    reportBatch(finished, chrono::duration<double, milli>(chrono::steady_clock::now() - batchStart).count(),
+                cpuTime() - cpuStart, &totals);
+
+    if (useSummary)
+    {
+        summary.close();
+        summary.report();
+    }
+    if (usePublisher)
+        publisher.report();
+}
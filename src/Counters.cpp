@@ -0,0 +1,192 @@
+/**
+ * @file Counters.cpp
+ * @author Matthew Harker
+ * @brief Counts hardware events (cycles, instructions, cache and branch
+ *          misses) around each task with perf_event_open, so the cost of the
+ *          matrix layout and of the branches in the evaluation can be seen
+ *          on the machine itself. Each thread opens its own counters once.
+ * @version 1.0
+ * @date 2019-06-15
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "Counters.h"
+
+using namespace std;
+
+// the names of the counters, as used in the summary table and the batch file
+const char* COUNTER_NAMES[COUNTER_COUNT] = { "cycles", "instructions", "l1d_misses", "llc_misses", "branch_misses" };
+
+/**
+ * @brief Construct a new Counters:: Counters object. Nothing is opened until
+ *          the first task starts.
+ *
+ */
+Counters::Counters()
+{
+    opened  = false;
+    running = false;
+    for (int c = 0; c < COUNTER_COUNT; ++c)
+        fds[c] = -1;
+}
+
+/**
+ * @brief Destroy the Counters:: Counters object, closing every event
+ *
+ */
+Counters::~Counters()
+{
+    for (int c = 0; c < COUNTER_COUNT; ++c)
+        if (fds[c] >= 0)
+            close(fds[c]);
+}
+
+/**
+ * @brief Opens every event for the calling thread, on any cpu, counting only
+ *          user space. The first thread to find events missing says so.
+ *
+ */
+void Counters::open()
+{
+    static const uint32_t types[COUNTER_COUNT] = {
+        PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE, PERF_TYPE_HW_CACHE, PERF_TYPE_HARDWARE
+    };
+    static const uint64_t configs[COUNTER_COUNT] = {
+        PERF_COUNT_HW_CPU_CYCLES,
+        PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+        PERF_COUNT_HW_CACHE_LL  | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+        PERF_COUNT_HW_BRANCH_MISSES
+    };
+    static atomic<bool> warned(false);
+
+    opened = true;
+
+    int missing = 0, error = 0;
+    for (int c = 0; c < COUNTER_COUNT; ++c)
+    {
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size           = sizeof(attr);
+        attr.type           = types[c];
+        attr.config         = configs[c];
+        attr.disabled       = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv     = 1;
+
+        // the times let a count be scaled when the events share a counter
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        fds[c] = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+        if (fds[c] < 0)
+        {
+            ++missing;
+            error = errno;
+        }
+    }
+
+    if (missing > 0 && !warned.exchange(true))
+    {
+        if (missing == COUNTER_COUNT)
+            cout << "Hardware counters are not available (" << strerror(error) << "), tasks run without them\n";
+        else
+            cout << missing << " hardware counter(s) are not available (" << strerror(error) << "), they are left empty\n";
+    }
+}
+
+/**
+ * @brief Resets and starts the counters of the calling thread
+ *
+ */
+void Counters::start()
+{
+    if (!opened)
+        open();
+
+    for (int c = 0; c < COUNTER_COUNT; ++c)
+    {
+        if (fds[c] < 0)
+            continue;
+
+        ioctl(fds[c], PERF_EVENT_IOC_RESET, 0);
+        ioctl(fds[c], PERF_EVENT_IOC_ENABLE, 0);
+    }
+    running = true;
+}
+
+/**
+ * @brief Stops the counters and reads them
+ *
+ * @param counts Receives the count of each event, or -1 if it was not counted
+ */
+void Counters::stop(long long* counts)
+{
+    for (int c = 0; c < COUNTER_COUNT; ++c)
+        if (fds[c] >= 0)
+            ioctl(fds[c], PERF_EVENT_IOC_DISABLE, 0);
+    running = false;
+
+    for (int c = 0; c < COUNTER_COUNT; ++c)
+    {
+        // the value, the time the event was enabled, and the time it ran
+        uint64_t values[3];
+        if (fds[c] < 0 || read(fds[c], values, sizeof(values)) != sizeof(values))
+        {
+            counts[c] = -1;
+            continue;
+        }
+
+        // an event that shared its counter is scaled up to the whole time
+        if (values[2] > 0 && values[2] < values[1])
+            counts[c] = (long long)((double)values[0] * values[1] / values[2]);
+        else
+            counts[c] = (values[2] > 0) ? (long long)values[0] : -1;
+    }
+}
+
+/**
+ * @brief Returns the counters of the calling thread, which are closed when
+ *          the thread ends
+ *
+ * @return Counters* The counters of the thread
+ */
+Counters* Counters::forThread()
+{
+    static thread_local Counters counters;
+    return &counters;
+}
+
+/**
+ * @brief Returns whether the counters are counting a task
+ *
+ * @return true If start() was called and stop() was not yet
+ */
+bool Counters::isRunning()
+{
+    return running;
+}
+
+/**
+ * @brief Returns a second set of counters of the calling thread, for work it
+ *          does for another thread's task (a block of a decomposition). They
+ *          count on their own, so the counters of the task the thread is
+ *          running are not reset.
+ *
+ * @return Counters* The thread's helper counters
+ */
+Counters* Counters::forHelper()
+{
+    static thread_local Counters counters;
+    return &counters;
+}
@@ -0,0 +1,296 @@
+/**
+ * @file Generator.cpp
+ * @author Matthew Harker
+ * @brief Makes flowshop instances with Taillard's random number generator.
+ *          The 120 Taillard instances in DataFiles can be made again from
+ *          their seeds, and instances of any size can be made with uniform,
+ *          correlated, or heavy-tailed processing times and written in the
+ *          text or binary format as they are made.
+ * @version 1.0
+ * @date 2019-06-16
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <fcntl.h>
+#include <iostream>
+#include <unistd.h>
+
+#include "Generator.h"
+#include "Instance.h"
+#include "OutputBuffer.h"
+
+using namespace std;
+
+// the size of a file's buffer before it is written out
+static const size_t GENERATE_FLUSH = 1 << 20;
+
+// the seeds of the Taillard instances ta001 to ta120, DataFiles/1.txt to 120.txt
+static const int32_t TAILLARD_SEEDS[120] = {
+    873654221,  379008056,  1866992158, 216771124,  495070989,  402959317,  1369363414, 2021925980, 573109518,  88325120,
+    587595453,  1401007982, 873136276,  268827376,  1634173168, 691823909,  73807235,   1273398721, 2065119309, 1672900551,
+    479340445,  268827376,  1958948863, 918272953,  555010963,  2010851491, 1519833303, 1748670931, 1923497586, 1829909967,
+    1328042058, 200382020,  496319842,  1203030903, 1730708564, 450926852,  1303135678, 1273398721, 587288402,  248421594,
+    1958948863, 575633267,  655816003,  1977864101, 93805469,   1803345551, 49612559,   1899802599, 2013025619, 578962478,
+    1539989115, 691823909,  655816003,  1315102446, 1949668355, 1923497586, 1805594913, 1861070898, 715643788,  464843328,
+    896678084,  1179439976, 1122278347, 416756875,  267829958,  1835213917, 1328833962, 1418570761, 161033112,  304212574,
+    1539989115, 655816003,  960914243,  1915696806, 2013025619, 1168140026, 1923497586, 167698528,  1528387973, 993794175,
+    450926852,  1462772409, 1021685265, 83696007,   508154254,  1861070898, 26482542,   444956424,  2115448041, 118254244,
+    471503978,  1215892992, 135346136,  1602504050, 160037322,  551454346,  519485142,  383947510,  1968171878, 540872513,
+    2013025619, 475051709,  914834335,  810642687,  1019331795, 2056065863, 1342855162, 1325809384, 1988803007, 765656702,
+    1368624604, 450181436,  1927888393, 1759567256, 606425239,  19268348,   1298201670, 2041736264, 379756761,  28837162
+};
+
+// the size (machines, jobs) of each group of ten Taillard instances
+static const int TAILLARD_SIZES[12][2] = {
+    { 5, 20 }, { 10, 20 }, { 20, 20 }, { 5, 50 }, { 10, 50 }, { 20, 50 },
+    { 5, 100 }, { 10, 100 }, { 20, 100 }, { 10, 200 }, { 20, 200 }, { 20, 500 }
+};
+
+// the best known upper bounds of the makespan of every Taillard instance
+// (permutation flow shop), as listed by Taillard
+static const int TAILLARD_UPPER_BOUNDS[120] = {
+    1278,  1359,  1081,  1293,  1235,  1195,  1234,  1206,  1230,  1108,
+    1582,  1659,  1496,  1377,  1419,  1397,  1484,  1538,  1593,  1591,
+    2297,  2099,  2326,  2223,  2291,  2226,  2273,  2200,  2237,  2178,
+    2724,  2834,  2621,  2751,  2863,  2829,  2725,  2683,  2552,  2782,
+    2991,  2867,  2839,  3063,  2976,  3006,  3093,  3037,  2897,  3065,
+    3850,  3704,  3640,  3720,  3610,  3681,  3704,  3691,  3743,  3756,
+    5493,  5268,  5175,  5014,  5250,  5135,  5246,  5094,  5448,  5322,
+    5770,  5349,  5676,  5781,  5467,  5303,  5595,  5617,  5871,  5845,
+    6202,  6183,  6271,  6269,  6314,  6364,  6268,  6401,  6275,  6434,
+    10862, 10480, 10922, 10889, 10524, 10329, 10854, 10730, 10438, 10675,
+    11195, 11203, 11281, 11275, 11259, 11176, 11360, 11334, 11192, 11288,
+    26040, 26520, 26371, 26456, 26334, 26469, 26389, 26560, 26005, 26457
+};
+
+/**
+ * @brief Converts the name of a distribution into its DIST_* value
+ *
+ * @param name  The name: uniform, correlated, or heavy
+ * @return int  The DIST_* value, or -1 if the name is unknown
+ */
+int parseDistribution(const string name)
+{
+    if (name == "uniform")    return DIST_UNIFORM;
+    if (name == "correlated") return DIST_CORRELATED;
+    if (name == "heavy")      return DIST_HEAVY;
+
+    return -1;
+}
+
+/**
+ * @brief Construct a new Taillard:: Taillard object
+ *
+ * @param s The seed, from 1 to 2^31 - 2
+ */
+Taillard::Taillard(const int32_t s)
+{
+    seed = s;
+}
+
+/**
+ * @brief Returns the next number of the sequence
+ *
+ * @return double A number in (0, 1)
+ */
+double Taillard::next()
+{
+    // Schrage's method: 2^31 - 1 = 16807 * 127773 + 2836
+    int32_t k = seed / 127773;
+    seed = 16807 * (seed % 127773) - k * 2836;
+    if (seed < 0)
+        seed += INT32_MAX;
+
+    return seed / (double)INT32_MAX;
+}
+
+/**
+ * @brief Returns a whole number between low and high, like Taillard's unif()
+ *
+ * @param low   The smallest number
+ * @param high  The largest number
+ * @return int  The number
+ */
+int Taillard::unif(const int low, const int high)
+{
+    return low + (int)(next() * (high - low + 1));
+}
+
+/**
+ * @brief Construct a new Generator:: Generator object. With the uniform
+ *          distribution and a Taillard seed it makes that Taillard instance.
+ *
+ * @param r             The number of machines
+ * @param c             The number of jobs
+ * @param seed          The seed of the generator
+ * @param distribution  The distribution of the times (DIST_*)
+ */
+Generator::Generator(const int r, const int c, const int32_t seed, const int distribution)
+    : random(seed)
+{
+    rows = r;
+    cols = c;
+    dist = distribution;
+
+    // a correlated instance first picks the typical time of every job
+    if (dist == DIST_CORRELATED)
+    {
+        base.resize(cols);
+        for (int j = 0; j < cols; ++j)
+            base[j] = random.unif(11, 89);
+    }
+}
+
+/**
+ * @brief Makes the times of the next machine
+ *
+ * @param row Receives one time for each job
+ */
+void Generator::nextRow(int* row)
+{
+    switch (dist)
+    {
+        case DIST_UNIFORM:
+            for (int j = 0; j < cols; ++j)
+                row[j] = random.unif(1, 99);
+            break;
+
+        case DIST_CORRELATED:
+            // within 10 of the job's typical time, so still 1 to 99
+            for (int j = 0; j < cols; ++j)
+                row[j] = base[j] + random.unif(-10, 10);
+            break;
+
+        case DIST_HEAVY:
+            // Pareto with shape 1.5 from 10, capped at 10000
+            for (int j = 0; j < cols; ++j)
+                row[j] = (int)min(10000.0, ceil(10 / pow(random.next(), 1 / 1.5)));
+            break;
+    }
+}
+
+/**
+ * @brief Makes the whole instance in memory
+ *
+ * @return Matrix* The instance
+ */
+Matrix* Generator::makeMatrix()
+{
+    Matrix* jobs = new Matrix(rows, cols);
+
+    for (int r = 0; r < rows; ++r)
+        nextRow(jobs->getRow(r));
+
+    return jobs;
+}
+
+/**
+ * @brief Finds the seed and size of a Taillard instance
+ *
+ * @param number    The instance, 1 (ta001) to 120 (ta120)
+ * @param seed      Receives the seed
+ * @param rows      Receives the number of machines
+ * @param cols      Receives the number of jobs
+ * @return true     If there is such an instance
+ */
+bool taillardInstance(const int number, int32_t& seed, int& rows, int& cols)
+{
+    if (number < 1 || number > 120)
+        return false;
+
+    seed = TAILLARD_SEEDS[number - 1];
+    rows = TAILLARD_SIZES[(number - 1) / 10][0];
+    cols = TAILLARD_SIZES[(number - 1) / 10][1];
+    return true;
+}
+
+/**
+ * @brief Returns the best known upper bound of a Taillard instance, the
+ *          makespan a solver is measured against
+ *
+ * @param number    The instance, 1 (ta001) to 120 (ta120)
+ * @return int      The upper bound of the FSS makespan, or -1 if there is no
+ *                      such instance
+ */
+int taillardUpperBound(const int number)
+{
+    if (number < 1 || number > 120)
+        return -1;
+
+    return TAILLARD_UPPER_BOUNDS[number - 1];
+}
+
+/**
+ * @brief Makes an instance and writes it as it is made, one megabyte at a
+ *          time, so its size is not limited by memory. The text format is
+ *          the one of the DataFiles, so a Taillard seed gives back the very
+ *          same file.
+ *
+ * @param pathname  The file to write
+ * @param rows      The number of machines
+ * @param cols      The number of jobs
+ * @param seed      The seed of the generator
+ * @param dist      The distribution of the times (DIST_*)
+ * @param binary    Whether to write the binary format instead of text
+ * @return true     If the whole file was written
+ */
+bool writeGenerated(const string pathname, const int rows, const int cols, const int32_t seed,
+                    const int dist, const bool binary)
+{
+    if (rows < 1 || cols < 1 || (long long)rows * cols > INT_MAX)
+    {
+        cout << "An instance of " << rows << " x " << cols << " is too large\n";
+        return false;
+    }
+
+    int fd = open(pathname.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+        return false;
+
+    Generator gen(rows, cols, seed, dist);
+    vector<int> row(cols);
+    OutputBuffer out;
+    bool ok = true;
+
+    if (binary)
+    {
+        InstanceHeader header = makeInstanceHeader(rows, cols);
+        out.putBytes(&header, sizeof(header));
+    }
+    else
+    {
+        out.putInt(rows); out.putChar(' '); out.putInt(cols); out.putString("\r\n");
+    }
+
+    for (int r = 0; r < rows && ok; ++r)
+    {
+        gen.nextRow(row.data());
+
+        if (binary)
+        {
+            out.putBytes(row.data(), cols * sizeof(int));
+        }
+        else
+        {
+            for (int j = 0; j < cols; ++j)
+            {
+                out.putInt(row[j]);
+                out.putChar(' ');
+            }
+            out.putString("\r\n");
+        }
+
+        if (out.size() >= GENERATE_FLUSH)
+        {
+            ok = out.writeTo(fd);
+            out.clear();
+        }
+    }
+
+    ok = ok && out.writeTo(fd);
+    return (close(fd) == 0) && ok;
+}
@@ -0,0 +1,90 @@
+/**
+ * @file Instance.cpp
+ * @author Matthew Harker
+ * @brief Writes and checks the binary instance format, which Matrix can
+ *          map and use directly instead of parsing the text DataFiles.
+ * @version 1.0
+ * @date 2019-06-08
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include "Instance.h"
+
+using namespace std;
+
+/**
+ * @brief Creates the header of an instance of the given size
+ *
+ * @param rows              The number of machines
+ * @param cols              The number of jobs
+ * @return InstanceHeader   The filled in header
+ */
+InstanceHeader makeInstanceHeader(const int rows, const int cols)
+{
+    InstanceHeader header;
+    memset(&header, 0, sizeof(header));
+
+    memcpy(header.magic, INSTANCE_MAGIC, 4);
+    header.version = INSTANCE_VERSION;
+    header.rows    = rows;
+    header.cols    = cols;
+    header.width   = sizeof(int);
+    header.offset  = INSTANCE_HEADER;
+
+    return header;
+}
+
+/**
+ * @brief Checks that a header belongs to a binary instance this program can
+ *          use, and that the file is large enough to hold it
+ *
+ * @param header    The header at the start of the file
+ * @param fileSize  The size of the whole file in bytes
+ * @return string   An empty string if the header is fine, otherwise the problem
+ */
+string checkInstanceHeader(const InstanceHeader* header, const size_t fileSize)
+{
+    if (fileSize < sizeof(InstanceHeader) || memcmp(header->magic, INSTANCE_MAGIC, 4) != 0)
+        return "is not a binary instance";
+    if (header->version != INSTANCE_VERSION)
+        return "has unsupported version " + to_string(header->version);
+    if (header->width != sizeof(int))
+        return "has " + to_string(header->width) + " byte values, expected " + to_string(sizeof(int));
+    if (header->rows < 1 || header->cols < 1 || (uint64_t)header->rows * header->cols > INT_MAX)
+        return "has a bad size";
+    if (header->offset < sizeof(InstanceHeader) || header->offset % sizeof(int) != 0)
+        return "has a bad header";
+    if (header->offset + (uint64_t)header->rows * header->cols * header->width > fileSize)
+        return "is shorter than its header says";
+
+    return "";
+}
+
+/**
+ * @brief Writes a matrix to a file in the binary instance format
+ *
+ * @param pathname  The file to write
+ * @param jobs      The matrix of job run times
+ * @return true     If the whole file was written
+ */
+bool writeInstance(const string pathname, Matrix* jobs)
+{
+    FILE* file = fopen(pathname.c_str(), "wb");
+    if (file == nullptr)
+        return false;
+
+    InstanceHeader header = makeInstanceHeader(jobs->getRows(), jobs->getCols());
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+
+    // the rows follow each other directly
+    for (int r = 0; r < jobs->getRows() && ok; ++r)
+        ok = fwrite(jobs->getRow(r), sizeof(int), jobs->getCols(), file) == (size_t)jobs->getCols();
+
+    return (fclose(file) == 0) && ok;
+}
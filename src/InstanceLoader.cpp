@@ -0,0 +1,215 @@
+/**
+ * @file InstanceLoader.cpp
+ * @author Matthew Harker
+ * @brief A single thread that reads and parses instances ahead of the
+ *          workers, in the order the tasks were queued, so a worker starting
+ *          a task finds its job matrix ready instead of waiting on the disk.
+ *          How far it reads ahead is bounded by a memory budget.
+ * @version 1.0
+ * @date 2019-06-10
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+#include "Allocations.h"
+#include "InstanceLoader.h"
+#include "Trace.h"
+
+using namespace std;
+
+/**
+ * @brief Construct a new InstanceLoader:: InstanceLoader object and start
+ *          the loader thread
+ *
+ * @param datafiles The datafile of every task, in the order they were queued
+ * @param source    The bundle to read the instances from, or nullptr
+ * @param bytes     How many bytes of instances may wait for the workers
+ * @param copy      Whether each worker copies its instance into memory it
+ *                      touches first, so it lands on the worker's NUMA node
+ */
+InstanceLoader::InstanceLoader(const vector<int>& datafiles, Bundle* source, const size_t bytes, const bool copy)
+{
+    order      = datafiles;
+    bundle     = source;
+    budget     = (bytes > 0) ? bytes : 1;
+    localCopy  = copy;
+    done       = false;
+    next       = 0;
+    readyBytes = 0;
+    loaded     = 0;
+    stalls     = 0;
+    stallTime  = 0;
+    loadTime   = 0;
+
+    loader = thread(&InstanceLoader::fill, this);
+}
+
+/**
+ * @brief Destroy the InstanceLoader:: InstanceLoader object. Frees any
+ *          instance no task took.
+ *
+ */
+InstanceLoader::~InstanceLoader()
+{
+    finish();
+
+    for (size_t i = 0; i < ready.size(); ++i)
+        delete ready[i].second;
+}
+
+/**
+ * @brief Hands a worker the instance of a datafile. Blocks until the loader
+ *          thread has read it. The worker takes ownership of the matrix, and
+ *          its allocations are counted as the worker's task's.
+ *
+ * @param datafile  The datafile of the worker's task
+ * @return Matrix*  The job matrix of the datafile
+ */
+Matrix* InstanceLoader::take(const int datafile)
+{
+    unique_lock<mutex> lock(queueMutex);
+
+    // the instance may already be waiting, workers don't always start in order
+    auto found = [this, datafile] {
+        return find_if(ready.begin(), ready.end(),
+            [datafile](const pair<int, Matrix*>& p) { return p.first == datafile; });
+    };
+
+    deque< pair<int, Matrix*> >::iterator it = found();
+    if (it == ready.end() && next < order.size())
+    {
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        notEmpty.wait(lock, [&] { it = found(); return it != ready.end() || next >= order.size(); });
+
+        ++stalls;
+        stallTime += chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    }
+
+    // a datafile the loader was never told about is read right here
+    if (it == ready.end())
+    {
+        lock.unlock();
+        return load(datafile);
+    }
+
+    Matrix* jobs = it->second;
+    readyBytes -= (size_t)jobs->getRows() * jobs->getCols() * sizeof(int);
+    ready.erase(it);
+
+    lock.unlock();
+    notFull.notify_one();
+
+    // the loader thread allocated the instance, it counts as the task's own
+    Allocations::adopt(jobs->countBlocks(), jobs->countBytes());
+
+    return localCopy ? copyLocal(jobs) : jobs;
+}
+
+/**
+ * @brief Stops the loader thread
+ *
+ */
+void InstanceLoader::finish()
+{
+    {
+        unique_lock<mutex> lock(queueMutex);
+        done = true;
+    }
+    notFull.notify_all();
+
+    if (loader.joinable())
+        loader.join();
+}
+
+/**
+ * @brief Prints how many instances were loaded ahead and how long workers
+ *          still waited for them
+ *
+ */
+void InstanceLoader::report()
+{
+    cout << "Loader: " << loaded << " instance(s) loaded ahead in " << loadTime << " ms, workers stalled ";
+    cout << stalls << " time(s) for " << stallTime << " ms\n";
+}
+
+/**
+ * @brief The loop of the loader thread. Loads the instances in order while
+ *          the ones waiting fit in the budget. One instance is always let
+ *          through, so an instance larger than the budget still loads.
+ *
+ */
+void InstanceLoader::fill()
+{
+    Trace::nameThread("loader");
+
+    for (;;)
+    {
+        int datafile;
+
+        {
+            unique_lock<mutex> lock(queueMutex);
+            notFull.wait(lock, [this] { return done || ready.empty() || readyBytes < budget; });
+            if (done || next >= order.size())
+                return;
+
+            datafile = order[next];
+        }
+
+        TraceScope trace("prefetch", "loader");
+        trace.setArg(0, "datafile", datafile);
+
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        Matrix* jobs = load(datafile);
+        double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+        {
+            unique_lock<mutex> lock(queueMutex);
+            ready.push_back(make_pair(datafile, jobs));
+            readyBytes += (size_t)jobs->getRows() * jobs->getCols() * sizeof(int);
+            ++next;
+            ++loaded;
+            loadTime += ms;
+        }
+        notEmpty.notify_all();
+    }
+}
+
+/**
+ * @brief Reads one instance, from the bundle if there is one
+ *
+ * @param datafile  The datafile to read
+ * @return Matrix*  The job matrix
+ */
+Matrix* InstanceLoader::load(const int datafile)
+{
+    Matrix* jobs = (bundle != nullptr) ? bundle->getMatrix(datafile) : nullptr;
+    if (jobs == nullptr)
+        jobs = new Matrix(datafile);
+
+    return jobs;
+}
+
+/**
+ * @brief Copies an instance into a matrix the calling worker allocates and
+ *          touches first. Views of a mapped file are shared and left as is.
+ *
+ * @param jobs      The instance the loader thread read, freed here
+ * @return Matrix*  The worker's own copy
+ */
+Matrix* InstanceLoader::copyLocal(Matrix* jobs)
+{
+    if (jobs->isView())
+        return jobs;
+
+    Matrix* local = new Matrix(jobs->getRows(), jobs->getCols());
+    for (int r = 0; r < jobs->getRows(); ++r)
+        copy(jobs->getRow(r), jobs->getRow(r) + jobs->getCols(), local->getRow(r));
+    local->generateJobCosts();
+
+    delete jobs;
+    return local;
+}
@@ -8,14 +8,27 @@
  * @copyright Copyright (c) 2019
  * 
  */
-#include <fstream>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <fcntl.h>
 #include <iostream>
 #include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
+#include "Allocations.h"
+#include "Instance.h"
 #include "Matrix.h"
 
 using namespace std;
 
+// totals of every file parsed, for the throughput report
+static atomic<long long> parsedBytes(0);
+static atomic<long long> parsedNanos(0);
+static atomic<long long> mappedFiles(0);
+
 /**
  * @brief Construct a new Matrix:: Matrix object
  * 
@@ -24,22 +37,17 @@ using namespace std;
  */
 Matrix::Matrix(const int r, const int c)
 {
-    // assign the sizes
-    rows = r;
-    cols = c;
-
-    // construct the matrix
-    matrix = new int*[rows];
-    for (int i = 0; i < rows; ++i)
-        matrix[i] = new int[cols];
-
-    // set default values to 0
-    for (int i = 0; i < rows; ++i)
-        for (int j = 0; j < cols; ++j)
-            matrix[i][j] = 0;
+    mapping     = nullptr;
+    mappingSize = 0;
+    borrowed    = false;
+
+    // construct the matrix with default values of 0
+    allocate(r, c);
+    for (int i = 0; i < rows * cols; ++i)
+        data[i] = 0;
     
     // construct jobCosts array
-    jobCosts = new int[cols];
+    jobCosts = Allocations::allocate<int>(cols);
 }
 
 /**
@@ -49,49 +57,25 @@ Matrix::Matrix(const int r, const int c)
  */
 Matrix::Matrix(int filename)
 {
+    mapping     = nullptr;
+    mappingSize = 0;
+    borrowed    = false;
+
     // finalize the pathname of the file
-    string pathname = "DataFiles/" + to_string(filename) + ".txt";
+    string base = "DataFiles/" + to_string(filename);
 
-    // string to hold the current line
-    string val;
+    // use the binary version when there is one that is up to date
+    struct stat txt, bin;
+    bool hasTxt = stat((base + ".txt").c_str(), &txt) == 0;
+    bool hasBin = stat((base + ".bin").c_str(), &bin) == 0;
 
-    // open the file
-    ifstream file(pathname);
-    if (file.is_open())
-    {
-        // first line contains rows and columns
-        file >> rows;
-        file >> cols;
-
-        // construct the matrix
-        matrix = new int*[rows];
-        for (int i = 0; i < rows; ++i)
-            matrix[i] = new int[cols];
-
-        // read in and assign the values to the matrix
-        for (int i = 0; i < rows; ++i)
-        {
-            // set the value of the elements in the row
-            for (int j = 0; j < cols; ++j)
-            {
-                // get the value and assign it
-                file >> val;
-                matrix[i][j] = stoi(val);
-            }
-        }
-    }
+    if (hasBin && (!hasTxt || bin.st_mtime >= txt.st_mtime))
+        loadBinary(base + ".bin");
     else
-    {
-        // if the file could not be opened
-        cout << "Matrix input file count not be found\n";
-        exit(EXIT_FAILURE);
-    }
-
-    // close the file
-    file.close();
+        load(base + ".txt");
 
     // setup the jobCosts array
-    jobCosts = new int[cols];
+    jobCosts = Allocations::allocate<int>(cols);
     generateJobCosts();
 }
 
@@ -102,67 +86,272 @@ Matrix::Matrix(int filename)
  */
 Matrix::Matrix(string filename)
 {
-    // finalize the pathname of the file
+    mapping     = nullptr;
+    mappingSize = 0;
+    borrowed    = false;
+
+    // finalize the pathname of the file and read it in
     string pathname = "DataFiles/" + filename;
+    if (filename.size() > 4 && filename.compare(filename.size() - 4, 4, ".bin") == 0)
+        loadBinary(pathname);
+    else
+        load(pathname);
+
+    // setup the jobCosts array
+    jobCosts = Allocations::allocate<int>(cols);
+    generateJobCosts();
+}
 
-    // string to hold the current line
-    string val;
+/**
+ * @brief Construct a new Matrix:: Matrix object that is a read-only view of
+ *          elements owned by someone else, such as an instance bundle. The
+ *          elements must outlive the matrix.
+ * 
+ * @param values    The elements, one row after the other
+ * @param r         How many rows the matrix has
+ * @param c         How many columns the matrix has
+ */
+Matrix::Matrix(const int* values, const int r, const int c)
+{
+    mapping     = nullptr;
+    mappingSize = 0;
+    borrowed    = true;
 
-    // open the file
-    ifstream file(pathname);
-    if (file.is_open())
-    {
-        // first line contains rows and columns
-        file >> rows;
-        file >> cols;
-
-        // construct the matrix
-        matrix = new int*[rows];
-        for (int i = 0; i < rows; ++i)
-            matrix[i] = new int[cols];
-
-        // read in and assign the values to the matrix
-        for (int i = 0; i < rows; ++i)
-        {
-            // set the value of the elements in the row
-            for (int j = 0; j < cols; ++j)
-            {
-                // get the value and assign it
-                file >> val;
-                matrix[i][j] = stoi(val);
-            }
-        }
-    }
-    else
+    rows = r;
+    cols = c;
+    data = nullptr;
+
+    // point each row into the borrowed elements
+    matrix = Allocations::allocate<int*>(rows);
+    for (int i = 0; i < rows; ++i)
+        matrix[i] = const_cast<int*>(values) + (size_t)i * cols;
+
+    // setup the jobCosts array
+    jobCosts = Allocations::allocate<int>(cols);
+    generateJobCosts();
+}
+
+/**
+ * @brief Destroy the Matrix:: Matrix object
+ * 
+ */
+Matrix::~Matrix()
+{
+    release();
+    Allocations::release(jobCosts, cols);
+}
+
+/**
+ * @brief Frees the elements of the matrix, or unmaps them if it is a view
+ * 
+ */
+void Matrix::release()
+{
+    Allocations::release(matrix, rows);
+    Allocations::release(data, (size_t)rows * cols);
+
+    if (mapping != nullptr)
+        munmap(mapping, mappingSize);
+
+    matrix   = nullptr;
+    data     = nullptr;
+    mapping  = nullptr;
+    borrowed = false;
+}
+
+/**
+ * @brief Allocates one contiguous block for the elements and points each
+ *          row of the matrix into it
+ * 
+ * @param r The number of rows
+ * @param c The number of columns
+ */
+void Matrix::allocate(const int r, const int c)
+{
+    rows = r;
+    cols = c;
+
+    data   = Allocations::allocate<int>((size_t)rows * cols);
+    matrix = Allocations::allocate<int*>(rows);
+    for (int i = 0; i < rows; ++i)
+        matrix[i] = data + (size_t)i * cols;
+}
+
+/**
+ * @brief Reads a matrix file. The file is mapped into memory and the values
+ *          are scanned straight into the matrix, with no stream or string in
+ *          between. The number of values must match the "rows cols" header.
+ * 
+ * @param pathname The path of the file to read
+ */
+void Matrix::load(const string pathname)
+{
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+    // open the file and map it
+    int fd = open(pathname.c_str(), O_RDONLY);
+    if (fd < 0)
     {
         // if the file could not be opened
         cout << "Matrix input file count not be found\n";
         exit(EXIT_FAILURE);
     }
 
-    // close the file
-    file.close();
+    struct stat info;
+    size_t size = (fstat(fd, &info) == 0) ? info.st_size : 0;
 
-    // setup the jobCosts array
-    jobCosts = new int[cols];
-    generateJobCosts();
+    void* mapped = (size > 0) ? mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+    close(fd);
+
+    if (mapped == MAP_FAILED)
+    {
+        cout << "Matrix input file " << pathname << " is empty or could not be read\n";
+        exit(EXIT_FAILURE);
+    }
+    madvise(mapped, size, MADV_SEQUENTIAL);
+
+    const char* pos = static_cast<const char*>(mapped);
+    const char* end = pos + size;
+
+    // first line contains rows and columns
+    long long r, c;
+    if (!scanInt(pos, end, r) || !scanInt(pos, end, c) || r < 1 || c < 1 || r * c > INT_MAX)
+    {
+        cout << "Matrix input file " << pathname << " has a bad \"rows cols\" header\n";
+        exit(EXIT_FAILURE);
+    }
+
+    // construct the matrix and read the values straight into it
+    allocate(r, c);
+
+    long long count = (long long)rows * cols;
+    long long found = 0;
+    long long val;
+    while (found < count && scanInt(pos, end, val))
+        data[found++] = val;
+
+    // nothing but whitespace may follow the values
+    long long extra;
+    bool trailing = scanInt(pos, end, extra);
+
+    if (found != count || trailing || pos != end)
+    {
+        cout << "Matrix input file " << pathname << " should hold " << rows << "x" << cols;
+        cout << " = " << count << " values, ";
+        if (pos != end && !trailing) cout << "found an unexpected character after " << found << "\n";
+        else if (trailing)           cout << "found more\n";
+        else                         cout << "found " << found << "\n";
+        exit(EXIT_FAILURE);
+    }
+
+    munmap(mapped, size);
+
+    parsedBytes += size;
+    parsedNanos += chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
 }
 
 /**
- * @brief Destroy the Matrix:: Matrix object
+ * @brief Opens a binary instance as a read-only view. The file is mapped and
+ *          the rows of the matrix point straight into it, so nothing is
+ *          parsed or copied. Writing to the elements of a view is an error.
  * 
+ * @param pathname The path of the binary instance
  */
-Matrix::~Matrix()
+void Matrix::loadBinary(const string pathname)
 {
-    if (matrix != nullptr)
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+    int fd = open(pathname.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        cout << "Matrix input file count not be found\n";
+        exit(EXIT_FAILURE);
+    }
+
+    struct stat info;
+    size_t size = (fstat(fd, &info) == 0) ? info.st_size : 0;
+
+    void* mapped = (size > 0) ? mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+    close(fd);
+
+    if (mapped == MAP_FAILED)
+    {
+        cout << "Matrix input file " << pathname << " is empty or could not be read\n";
+        exit(EXIT_FAILURE);
+    }
+
+    const InstanceHeader* header = static_cast<const InstanceHeader*>(mapped);
+    string problem = checkInstanceHeader(header, size);
+    if (!problem.empty())
     {
-        for (int i = 0; i < rows; ++i)
-            delete[] matrix[i];
-        delete[] matrix;
+        cout << "Matrix input file " << pathname << " " << problem << "\n";
+        exit(EXIT_FAILURE);
     }
 
-    if (jobCosts != nullptr)
-        delete[] jobCosts;
+    // point each row into the mapping
+    rows        = header->rows;
+    cols        = header->cols;
+    data        = nullptr;
+    mapping     = mapped;
+    mappingSize = size;
+
+    int* values = reinterpret_cast<int*>(static_cast<char*>(mapped) + header->offset);
+    matrix = Allocations::allocate<int*>(rows);
+    for (int i = 0; i < rows; ++i)
+        matrix[i] = values + (size_t)i * cols;
+
+    ++mappedFiles;
+    parsedNanos += chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * @brief Scans the next integer of a mapped file. Skips leading whitespace.
+ * 
+ * @param pos   The current position, moved past the integer
+ * @param end   The end of the file
+ * @param val   Receives the integer
+ * @return true If an integer was found, false at the end of the file or if
+ *              something other than an integer is next (pos is left there)
+ */
+bool Matrix::scanInt(const char*& pos, const char* end, long long& val)
+{
+    // skip the whitespace
+    while (pos < end && (*pos == ' ' || *pos == '\n' || *pos == '\t' || *pos == '\r'))
+        ++pos;
+
+    const char* p = pos;
+    bool negative = (p < end && *p == '-');
+    if (negative) ++p;
+
+    if (p == end || *p < '0' || *p > '9')
+        return false;
+
+    long long num = 0;
+    while (p < end && *p >= '0' && *p <= '9' && num <= INT_MAX)
+        num = num * 10 + (*p++ - '0');
+
+    // a number must end at whitespace or the end of the file
+    if (num > INT_MAX || (p < end && *p != ' ' && *p != '\n' && *p != '\t' && *p != '\r'))
+        return false;
+
+    val = negative ? -num : num;
+    pos = p;
+    return true;
+}
+
+/**
+ * @brief Prints how much matrix file data has been parsed and how fast
+ * 
+ */
+void Matrix::reportParsing()
+{
+    double mb = parsedBytes / (1024.0 * 1024.0);
+    double ms = parsedNanos / 1e6;
+
+    cout << "Parser: " << mb << " MB in " << ms << " ms";
+    if (ms > 0) cout << " (" << mb / (ms / 1000.0) << " MB/s)";
+    if (mappedFiles > 0) cout << ", " << mappedFiles << " binary instance(s) mapped";
+    cout << "\n";
 }
 
 /**
@@ -175,6 +364,44 @@ int Matrix::getRows()
     return rows;
 }
 
+/**
+ * @brief Returns whether the matrix is a read-only view of a binary instance
+ *          or a bundle
+ * 
+ * @return true If the elements belong to a mapped file
+ */
+bool Matrix::isView()
+{
+    return mapping != nullptr || borrowed;
+}
+
+/**
+ * @brief Returns how many counted blocks (see Allocations) the matrix holds
+ * 
+ * @return int The number of blocks
+ */
+int Matrix::countBlocks()
+{
+    return (data != nullptr) + (matrix != nullptr) + (jobCosts != nullptr);
+}
+
+/**
+ * @brief Returns how many counted bytes (see Allocations) the matrix holds.
+ *          The elements of a view belong to someone else and are left out.
+ * 
+ * @return long long The number of bytes
+ */
+long long Matrix::countBytes()
+{
+    long long bytes = (long long)cols * sizeof(int);
+    if (matrix != nullptr)
+        bytes += (long long)rows * sizeof(int*);
+    if (data != nullptr)
+        bytes += (long long)rows * cols * sizeof(int);
+
+    return bytes;
+}
+
 /**
  * @brief Returns the number of columns
  * 
@@ -246,6 +473,17 @@ int Matrix::getFinalVal()
     return matrix[rows-1][cols-1];
 }
 
+/**
+ * @brief Returns one row of the matrix, for kernels that walk a whole row
+ * 
+ * @param r     The row to return
+ * @return int* The elements of the row
+ */
+int* Matrix::getRow(const int r)
+{
+    return matrix[r];
+}
+
 /**
  * @brief Sets the value of a specified element in the matrix
  * 
@@ -264,9 +502,8 @@ void Matrix::setVal(int newVal, const int r, const int c)
  */
 void Matrix::clearMatrix()
 {
-    for (int r = 0; r < rows; ++r)
-        for (int c = 0; c < cols; ++c)
-            matrix[r][c] = 0;
+    for (int i = 0; i < rows * cols; ++i)
+        data[i] = 0;
 }
 
 /**
@@ -277,22 +514,14 @@ void Matrix::clearMatrix()
  */
 void Matrix::resize(const int newR, const int newC)
 {
-    // assign the size values
-    rows = newR;
-    cols = newC;
-
-    // create a new temp array of the new size
-    int** temp = new int*[rows];
-    for (int i = 0; i < rows; ++i)
-        temp[i] = new int[cols];
-    
-    // change the pointer of the original array to that of the new one
-    matrix = temp;
-
-    // delete the temp matrix
-    for (int i = 0; i < rows; ++i)
-        delete[] temp[i];
-    delete[] temp;
+    // free the old elements and allocate the new ones
+    int oldCols = cols;
+    release();
+    allocate(newR, newC);
+
+    // the job costs need one element per column
+    Allocations::release(jobCosts, oldCols);
+    jobCosts = Allocations::allocate<int>(cols);
 }
 
 /**
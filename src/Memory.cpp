@@ -8,22 +8,71 @@
  * @copyright Copyright (c) 2019
  * 
  */
+#include <algorithm>
+#include <cstring>
 #include <iostream>
-#include <fstream>
-#include <sstream>
 
 #include "flowshop.h"
+#include "Gantt.h"
 #include "Matrix.h"
 #include "Memory.h"
 #include "Permutation.h"
 
+using namespace std;
+
+// the names of the phases, as used in the summary table and the batch file
+const char* PHASE_NAMES[PHASE_COUNT] = { "load", "sort", "neh", "improvement", "write" };
+
+/**
+ * @brief Converts the name of a Gantt format into its GANTT_* flags
+ * 
+ * @param name  The name of the format: csv, binary, or both
+ * @return int  The GANTT_* flags of the format
+ */
+int parseGanttFormat(const string name)
+{
+    if (name == "binary") return GANTT_BINARY;
+    if (name == "both")   return GANTT_CSV | GANTT_BINARY;
+
+    if (name != "csv")
+        cout << "Unknown gantt format \"" << name << "\", writing csv\n";
+
+    return GANTT_CSV;
+}
+
+/**
+ * @brief Converts the name of an output level into its OUTPUT_* value
+ * 
+ * @param name  The name of the level: summary, schedule, or full
+ * @return int  The OUTPUT_* value of the level
+ */
+int parseOutputLevel(const string name)
+{
+    if (name == "schedule") return OUTPUT_SCHEDULE;
+    if (name == "full")     return OUTPUT_FULL;
+
+    if (name != "summary")
+        cout << "Unknown output \"" << name << "\", only the summary will be written\n";
+
+    return OUTPUT_SUMMARY;
+}
+
 /**
  * @brief Construct a new Memory:: Memory object
  * 
  */
 Memory::Memory()
 {
-    funcCalls = 0;
+    funcCalls    = 0;
+    timeTaken    = 0;
+    originalCmax = 0;
+
+    for (int p = 0; p < PHASE_COUNT; ++p)
+        phaseTimes[p] = 0;
+    for (int c = 0; c < COUNTER_COUNT; ++c)
+        counts[c] = -1;
+    for (int a = 0; a < ALLOC_STATS; ++a)
+        allocs[a] = -1;
 }
 
 /**
@@ -35,6 +84,16 @@ void Memory::incrFuncCalls()
     ++funcCalls;
 }
 
+/**
+ * @brief Adds function calls made elsewhere (such as by another thread)
+ * 
+ * @param calls The number of function calls to add
+ */
+void Memory::addFuncCalls(const int calls)
+{
+    funcCalls += calls;
+}
+
 /**
  * @brief Returns the value of funcCalls
  * 
@@ -46,12 +105,13 @@ int Memory::getFuncCalls()
 }
 
 /**
- * @brief Starts a timer
+ * @brief Starts a timer. The timer is a monotonic wall clock, so the time of
+ *          a task does not include the work of the other threads.
  * 
  */
 void Memory::startTimer()
 {
-    timer = clock();
+    timer = chrono::steady_clock::now();
 }
 
 /**
@@ -60,8 +120,311 @@ void Memory::startTimer()
  */
 void Memory::stopTimer()
 {
-    timer = clock() - timer;
-    timeTaken = double(timer*1000)/CLOCKS_PER_SEC;
+    timeTaken = chrono::duration<double, milli>(chrono::steady_clock::now() - timer).count();
+}
+
+/**
+ * @brief Sets the value of timeTaken
+ * 
+ * @param time The time (ms) the algorithm took
+ */
+void Memory::setTimeTaken(const double time)
+{
+    timeTaken = time;
+}
+
+/**
+ * @brief Returns the value of timeTaken
+ * 
+ * @return double The time (ms) the algorithm took
+ */
+double Memory::getTimeTaken()
+{
+    return timeTaken;
+}
+
+/**
+ * @brief Starts timing a phase
+ * 
+ */
+void Memory::startPhase()
+{
+    phaseStart = chrono::steady_clock::now();
+}
+
+/**
+ * @brief Adds the time since the phase started to a phase, and starts the
+ *          next phase, so phases that follow each other can be timed
+ *          without gaps
+ * 
+ * @param phase The phase (PHASE_*) that just ended
+ */
+void Memory::endPhase(const int phase)
+{
+    chrono::steady_clock::time_point now = chrono::steady_clock::now();
+    phaseTimes[phase] += chrono::duration<double, milli>(now - phaseStart).count();
+    phaseStart = now;
+}
+
+/**
+ * @brief Sets how long a phase took
+ * 
+ * @param phase The phase (PHASE_*)
+ * @param time  The time (ms) the phase took
+ */
+void Memory::setPhaseTime(const int phase, const double time)
+{
+    phaseTimes[phase] = time;
+}
+
+/**
+ * @brief Returns how long a phase took
+ * 
+ * @param phase     The phase (PHASE_*)
+ * @return double   The time (ms) the phase took
+ */
+double Memory::getPhaseTime(const int phase)
+{
+    return phaseTimes[phase];
+}
+
+/**
+ * @brief Sets the hardware counts of the task
+ * 
+ * @param values The count of each COUNTER_* event, -1 for one not counted
+ */
+void Memory::setCounts(const long long* values)
+{
+    for (int c = 0; c < COUNTER_COUNT; ++c)
+        counts[c] = values[c];
+}
+
+/**
+ * @brief Adds hardware counts to the task's, such as those of the work
+ *          other threads did for it
+ * 
+ * @param values The count of each COUNTER_* event, -1 for one not counted
+ */
+void Memory::addCounts(const long long* values)
+{
+    for (int c = 0; c < COUNTER_COUNT; ++c)
+        if (values[c] >= 0)
+            counts[c] = max(counts[c], 0LL) + values[c];
+}
+
+/**
+ * @brief Returns a hardware count of the task
+ * 
+ * @param counter       The event (COUNTER_*)
+ * @return long long    The count, or -1 if it was not counted
+ */
+long long Memory::getCount(const int counter)
+{
+    return counts[counter];
+}
+
+/**
+ * @brief Returns whether any hardware event was counted
+ * 
+ * @return true If at least one count is known
+ */
+bool Memory::hasCounts()
+{
+    for (int c = 0; c < COUNTER_COUNT; ++c)
+        if (counts[c] >= 0)
+            return true;
+
+    return false;
+}
+
+/**
+ * @brief Sets the allocation statistics of the task
+ * 
+ * @param values Each ALLOC_* statistic, -1 for one not counted
+ */
+void Memory::setAllocations(const long long* values)
+{
+    for (int a = 0; a < ALLOC_STATS; ++a)
+        allocs[a] = values[a];
+}
+
+/**
+ * @brief Returns an allocation statistic of the task
+ * 
+ * @param stat          The statistic (ALLOC_*)
+ * @return long long    Its value, or -1 if it was not counted
+ */
+long long Memory::getAllocation(const int stat)
+{
+    return allocs[stat];
+}
+
+/**
+ * @brief Returns whether the allocations of the task were counted
+ * 
+ * @return true If the statistics are known
+ */
+bool Memory::hasAllocations()
+{
+    return allocs[ALLOC_COUNT] >= 0;
+}
+
+/**
+ * @brief Adds the function calls, times, and counts of one task to the totals
+ *          of a batch. Allocations and bytes are summed, the peak and the
+ *          resident size keep the largest.
+ * 
+ * @param task The statistics of the task
+ */
+void Memory::addTotals(Memory& task)
+{
+    funcCalls += task.funcCalls;
+    timeTaken += task.timeTaken;
+
+    for (int p = 0; p < PHASE_COUNT; ++p)
+        phaseTimes[p] += task.phaseTimes[p];
+
+    for (int c = 0; c < COUNTER_COUNT; ++c)
+        if (task.counts[c] >= 0)
+            counts[c] = max(counts[c], 0LL) + task.counts[c];
+
+    if (task.hasAllocations())
+    {
+        allocs[ALLOC_COUNT] = max(allocs[ALLOC_COUNT], 0LL) + task.allocs[ALLOC_COUNT];
+        allocs[ALLOC_BYTES] = max(allocs[ALLOC_BYTES], 0LL) + task.allocs[ALLOC_BYTES];
+        allocs[ALLOC_PEAK]  = max(allocs[ALLOC_PEAK], task.allocs[ALLOC_PEAK]);
+        allocs[ALLOC_RSS]   = max(allocs[ALLOC_RSS], task.allocs[ALLOC_RSS]);
+    }
+}
+
+/**
+ * @brief Writes the counts that are known as " name value" pairs
+ * 
+ * @param counts    The count of each COUNTER_* event
+ * @param out       The buffer to write into
+ */
+static void putCounts(const long long* counts, OutputBuffer* out)
+{
+    for (int c = 0; c < COUNTER_COUNT; ++c)
+    {
+        if (counts[c] < 0)
+            continue;
+
+        out->putChar(' '); out->putString(COUNTER_NAMES[c]);
+        out->putChar(' '); out->putInt(counts[c]);
+    }
+}
+
+/**
+ * @brief Writes the allocation statistics as " name value" pairs
+ * 
+ * @param allocs    Each ALLOC_* statistic
+ * @param out       The buffer to write into
+ */
+static void putAllocations(const long long* allocs, OutputBuffer* out)
+{
+    for (int a = 0; a < ALLOC_STATS; ++a)
+    {
+        out->putChar(' '); out->putString(ALLOC_NAMES[a]);
+        out->putChar(' '); out->putInt(allocs[a]);
+    }
+}
+
+/**
+ * @brief Writes the times of a whole batch to results/batch.txt. The wall
+ *          time is how long the batch took, the CPU time is what every
+ *          thread (and worker process) used, and the phases are summed over
+ *          every task.
+ * 
+ * @param tasks     How many tasks the batch finished
+ * @param wallTime  How long the batch took (ms)
+ * @param cpuTime   The CPU time the batch used (ms)
+ * @param out       The buffer the file is formatted into
+ */
+void Memory::writeBatchData(const long tasks, const double wallTime, const double cpuTime, OutputBuffer* out)
+{
+    out->clear();
+    out->putString("Tasks: ");            out->putInt(tasks);        out->putChar('\n');
+    out->putString("Function calls: ");   out->putInt(funcCalls);    out->putChar('\n');
+    out->putString("Wall time (ms): ");   out->putDouble(wallTime);  out->putChar('\n');
+    out->putString("CPU time (ms): ");    out->putDouble(cpuTime);   out->putChar('\n');
+    out->putString("Time taken (ms): ");  out->putDouble(timeTaken); out->putChar('\n');
+
+    // the phases summed over every task
+    out->putString("\nPhase times (ms):\n");
+    for (int p = 0; p < PHASE_COUNT; ++p)
+    {
+        out->putString(PHASE_NAMES[p]); out->putString(": ");
+        out->putDouble(phaseTimes[p]);  out->putChar('\n');
+    }
+
+    // the hardware counts summed over every task that was counted
+    if (hasCounts())
+    {
+        out->putString("\nCounters:");
+        putCounts(counts, out);
+        out->putChar('\n');
+    }
+
+    // the allocations summed over every task (the largest peak of a task),
+    // and what the whole process still holds and ever held
+    if (hasAllocations())
+    {
+        out->putString("\nAllocations:");
+        putAllocations(allocs, out);
+        out->putString("\nProcess memory: live_bytes "); out->putInt(Allocations::getLive());
+        out->putString(" peak_bytes ");                   out->putInt(Allocations::getPeak());
+        out->putString(" rss_kb ");                       out->putInt(Allocations::residentKB());
+        out->putString(" rss_peak_kb ");                  out->putInt(Allocations::peakResidentKB());
+        out->putChar('\n');
+    }
+
+    if (!out->writeFile("results/batch.txt"))
+        cout << "Could not write results/batch.txt\n";
+}
+
+/**
+ * @brief Sets the makespan of the jobs in their original order, which is
+ *          worked out once when the instance is read
+ * 
+ * @param cmax The makespan of the original order
+ */
+void Memory::setOriginalCmax(const int cmax)
+{
+    originalCmax = cmax;
+}
+
+/**
+ * @brief Returns the makespan of the jobs in their original order
+ * 
+ * @return int The makespan of the original order
+ */
+int Memory::getOriginalCmax()
+{
+    return originalCmax;
+}
+
+/**
+ * @brief Builds the path of an output file, such as "results/rawData/FSS/fss-12.txt"
+ * 
+ * @param path      Receives the path, 128 characters is enough
+ * @param dir       The directory of every algorithm's files
+ * @param alg       The algorithm that the system went through
+ * @param name      The start of the file name of each algorithm (fss, fssb, fssnw)
+ * @param datafile  Which datafile the job run time matrix used
+ * @param ext       The end of the file name
+ */
+static void makePath(char* path, const char* dir, const int alg, const char* name, const int datafile, const char* ext)
+{
+    static const char* algDirs[]  = { "", "FSS/fss", "FSSB/fssb", "FSSNW/fssnw" };
+    const char* algDir = (alg >= 1 && alg <= 3) ? algDirs[alg] : "";
+
+    char* p = path;
+    p = stpcpy(p, dir);
+    p = stpcpy(p, algDir);
+    if (alg >= 1 && alg <= 3) p = stpcpy(p, name);
+    p = OutputBuffer::formatInt(p, datafile);
+    strcpy(p, ext);
 }
 
 /**
@@ -72,11 +435,19 @@ void Memory::stopTimer()
  * @param perm      The permutation object containing the best job sequence
  * @param alg       The algorithm that the system went through
  * @param datafile  Which datafile the job run time matrix used
+ * @param gantt     Which Gantt files to write (GANTT_* flags, 0 for none)
+ * @param out       The buffer each file is formatted into
  */
-void Memory::writeAllData(Matrix* jobs, Matrix* comp, Permutation* perm, const int alg, const int datafile)
+void Memory::writeAllData(Matrix* jobs, Matrix* comp, Permutation* perm, const int alg, const int datafile, const int gantt, OutputBuffer* out)
 {
-    writeRawData  (jobs, comp, perm, alg, datafile);
-    writeGanttData(jobs, comp, perm, alg, datafile);
+    writeRawData(jobs, comp, perm, alg, datafile, out);
+
+    if (gantt == 0)
+        return;
+    if (gantt & GANTT_CSV)
+        writeGanttData(jobs, comp, perm, alg, datafile, out);
+    if (gantt & GANTT_BINARY)
+        writeGanttBinary(jobs, comp, perm, alg, datafile, out);
 }
 
 /**
@@ -87,70 +458,104 @@ void Memory::writeAllData(Matrix* jobs, Matrix* comp, Permutation* perm, const i
  * @param perm      The permutation object containing the best job sequence
  * @param alg       The algorithm that the system went through
  * @param datafile  Which datafile the job run time matrix used
+ * @param out       The buffer the file is formatted into
  */
-void Memory::writeRawData(Matrix* jobs, Matrix* comp, Permutation* perm, const int alg, const int datafile)
+void Memory::writeRawData(Matrix* jobs, Matrix* comp, Permutation* perm, const int alg, const int datafile, OutputBuffer* out)
 {
-    // set the correct path to write the file to amd open it
-    string pathname = "results/rawData/";
-    if      (alg == 1) pathname += "FSS/fss-";
-    else if (alg == 2) pathname += "FSSB/fssb-";
-    else if (alg == 3) pathname += "FSSNW/fssnw-";
-    pathname += to_string(datafile) += ".txt";
-    ofstream txt(pathname);
+    // set the correct path to write the file to
+    char pathname[128];
+    makePath(pathname, "results/rawData/", alg, "-", datafile, ".txt");
+
+    int rows = jobs->getRows();
+    int cols = jobs->getCols();
+    int* seq = perm->getPerm();
 
-    txt << "Dimensions (RxC): ";
-    txt << jobs->getRows() << " " << jobs->getCols() << '\n';   // dimensions of the matrix
-    txt << "Function calls: " << funcCalls << "\n";             // number of func calls
-    txt << "Time taken: " << timeTaken << "\n\n";               // time taken (ms)
+    out->clear();
+    out->putString("Dimensions (RxC): ");
+    out->putInt(rows); out->putChar(' '); out->putInt(cols); out->putChar('\n');    // dimensions of the matrix
+    out->putString("Function calls: "); out->putInt(funcCalls); out->putChar('\n');  // number of func calls
+    out->putString("Time taken: "); out->putDouble(timeTaken); out->putChar('\n');     // time taken (ms)
+
+    // the time of each phase (ms), the files being written are not timed yet
+    out->putString("Phase times:");
+    for (int p = 0; p < PHASE_WRITE; ++p)
+    {
+        out->putChar(' '); out->putString(PHASE_NAMES[p]);
+        out->putChar(' '); out->putDouble(phaseTimes[p]);
+    }
+    out->putChar('\n');
+
+    // the hardware counts of the task, when they were counted
+    if (hasCounts())
+    {
+        out->putString("Counters:");
+        putCounts(counts, out);
+        out->putChar('\n');
+    }
+
+    // the allocations of the task, when they were counted
+    if (hasAllocations())
+    {
+        out->putString("Allocations:");
+        putAllocations(allocs, out);
+        out->putChar('\n');
+    }
+    out->putChar('\n');
 
     // write the optimized fitness and the original fitness
-    txt << "Optimized Cmax: " <<  perm->getBestVal() << '\n';
-    txt << "Original Cmax: "; 
-    Matrix* temp = new Matrix(jobs->getRows(), jobs->getCols());    // temp mtx to preserve data
-    if      (alg == 1) txt << fss  (jobs, temp) << '\n';
-    else if (alg == 2) txt << fssb (jobs, temp) << '\n';
-    else if (alg == 3) txt << fssnw(jobs, temp) << '\n';
-    delete temp;
+    out->putString("Optimized Cmax: "); out->putInt(perm->getBestVal()); out->putChar('\n');
+    out->putString("Original Cmax: ");  out->putInt(originalCmax);       out->putChar('\n');
 
     // write the permutation sequence
-    txt << "\nPermutaion sequence:\n";
-    txt << perm->getBest(0) + 1;
+    out->putString("\nPermutaion sequence:\n");
+    out->putInt(perm->getBest(0) + 1);
     for (int i = 1; i < perm->getSize(); ++i)
-        txt << "," << perm->getBest(i) + 1;
-    txt << '\n';
+    {
+        out->putChar(',');
+        out->putInt(perm->getBest(i) + 1);
+    }
+    out->putChar('\n');
 
     // write the completion times
-    txt << "\nCompletion times:\n";
+    out->putString("\nCompletion times:\n");
 
-    for (int r = 0; r < jobs->getRows(); ++r)
+    for (int r = 0; r < rows; ++r)
     {
+        int* compRow = comp->getRow(r);
+
         // write first value for no trailing commas
-        txt << comp->getVal(r, 0);
+        out->putInt(compRow[0]);
 
         // write the rest of the values
-        for (int c = 1; c < jobs->getCols(); ++c)
-            txt << "," << comp->getVal(r, c);
-        txt << '\n';
+        for (int c = 1; c < cols; ++c)
+        {
+            out->putChar(',');
+            out->putInt(compRow[c]);
+        }
+        out->putChar('\n');
     }
 
+    // write the start times (completion time minus run time)
+    out->putString("\nStart times:\n");
 
-    // write the start times (completion time minues)
-    txt << "\nStart times:\n";
-
-    for (int r = 0; r < jobs->getRows(); ++r)
+    for (int r = 0; r < rows; ++r)
     {
+        int* compRow = comp->getRow(r);
+        int* jobRow  = jobs->getRow(r);
+
         // write first value for no trailing commas
-        int ind = perm->getPerm(0);
-        txt << comp->getVal(r, 0) - jobs->getVal(r, ind);
+        out->putInt(compRow[0] - jobRow[seq[0]]);
 
         // write the rest of the values
-        for (int c = 1; c < jobs->getCols(); ++c)
+        for (int c = 1; c < cols; ++c)
         {
-            ind = perm->getPerm(c);
-            txt << "," << comp->getVal(r, c) - jobs->getVal(r, ind);
+            out->putChar(',');
+            out->putInt(compRow[c] - jobRow[seq[c]]);
         }
-        txt << '\n';
+        out->putChar('\n');
     }
+
+    out->writeFile(pathname);
 }
 
 /**
@@ -162,31 +567,103 @@ void Memory::writeRawData(Matrix* jobs, Matrix* comp, Permutation* perm, const i
  * @param perm      The permutation object containing the best job sequence
  * @param alg       The algorithm that the system went through
  * @param datafile  Which datafile the job run time matrix used
+ * @param out       The buffer the file is formatted into
  */
-void Memory::writeGanttData(Matrix* jobs, Matrix* comp, Permutation* perm, const int alg, const int datafile)
+void Memory::writeGanttData(Matrix* jobs, Matrix* comp, Permutation* perm, const int alg, const int datafile, OutputBuffer* out)
 {
-    // set the correct path to write the file to and open it
-    string pathname = "results/ganttData/";
-    if      (alg == 1) pathname += "FSS/fss_gantt-";
-    else if (alg == 2) pathname += "FSSB/fssb_gantt-";
-    else if (alg == 3) pathname += "FSSNW/fssnw_gantt-";
-    pathname += to_string(datafile) += ".csv";
-    ofstream csv(pathname);
+    // set the correct path to write the file to
+    char pathname[128];
+    makePath(pathname, "results/ganttData/", alg, "_gantt-", datafile, ".csv");
+
+    int rows = jobs->getRows();
+    int cols = jobs->getCols();
+    int* seq = perm->getPerm();
 
     // write the header to the file
-    csv << "Item,Machine,Job,Start,End" << '\n';
+    out->clear();
+    out->putString("Item,Machine,Job,Start,End\n");
 
     // fill in the rest of the data
     int item = 0;
-    for (int r = 0; r < jobs->getRows(); ++r)
+    for (int r = 0; r < rows; ++r)
     {
-        for (int c = 0; c < jobs->getCols(); ++c)
+        int* compRow = comp->getRow(r);
+        int* jobRow  = jobs->getRow(r);
+
+        for (int c = 0; c < cols; ++c)
         {
-            int ind = perm->getPerm(c);
-            csv << ++item << ",Machine " << r+1 << ",Job " << c+1 << ',';
-            csv << comp->getVal(r, c) - jobs->getVal(r, ind);
-            csv << ',' << comp->getVal(r, c) << '\n';
+            out->putInt(++item);
+            out->putString(",Machine "); out->putInt(r + 1);
+            out->putString(",Job ");     out->putInt(c + 1);
+            out->putChar(',');           out->putInt(compRow[c] - jobRow[seq[c]]);
+            out->putChar(',');           out->putInt(compRow[c]);
+            out->putChar('\n');
         }
+    }
+
+    out->writeFile(pathname);
+}
+
+/**
+ * @brief Writes the schedule in the columnar binary Gantt format: the
+ *          sequence, then every start time, then every end time, each as
+ *          one contiguous array (see Gantt.h)
+ * 
+ * @param jobs      The matrix of job run times
+ * @param comp      The matrix of job completion times
+ * @param perm      The permutation object containing the best job sequence
+ * @param alg       The algorithm that the system went through
+ * @param datafile  Which datafile the job run time matrix used
+ * @param out       The buffer the file is formatted into
+ */
+void Memory::writeGanttBinary(Matrix* jobs, Matrix* comp, Permutation* perm, const int alg, const int datafile, OutputBuffer* out)
+{
+    // set the correct path to write the file to
+    char pathname[128];
+    makePath(pathname, "results/ganttData/", alg, "_gantt-", datafile, ".bin");
+
+    int rows = jobs->getRows();
+    int cols = jobs->getCols();
+    int* seq = perm->getPerm();
+
+    uint64_t cells = (uint64_t)rows * cols * sizeof(int);
+
+    GanttHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, GANTT_MAGIC, 4);
+    header.version  = GANTT_VERSION;
+    header.datafile = datafile;
+    header.alg      = alg;
+    header.rows     = rows;
+    header.cols     = cols;
+    header.width    = sizeof(int);
+    header.cmax     = perm->getBestVal();
+    header.sequenceOffset = sizeof(GanttHeader);
+    header.startOffset    = header.sequenceOffset + ((uint64_t)cols * sizeof(int) + 7) / 8 * 8;
+    header.endOffset      = header.startOffset + (cells + 7) / 8 * 8;
+
+    out->clear();
+    out->putBytes(&header, sizeof(header));
+    out->putBytes(seq, cols * sizeof(int));
+    out->align(8);
 
+    // the start times, worked out one machine at a time
+    for (int r = 0; r < rows; ++r)
+    {
+        int* compRow = comp->getRow(r);
+        int* jobRow  = jobs->getRow(r);
+
+        for (int c = 0; c < cols; ++c)
+        {
+            int start = compRow[c] - jobRow[seq[c]];
+            out->putBytes(&start, sizeof(int));
+        }
     }
+    out->align(8);
+
+    // the end times are the completion times as they are
+    for (int r = 0; r < rows; ++r)
+        out->putBytes(comp->getRow(r), cols * sizeof(int));
+
+    out->writeFile(pathname);
 }
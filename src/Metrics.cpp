@@ -0,0 +1,427 @@
+/**
+ * @file Metrics.cpp
+ * @author Matthew Harker
+ * @brief Live metrics of a batch. Every thread counts its evaluations and
+ *          tasks, and records how long each evaluation took, into counters
+ *          of its own. A reporter thread prints the evaluations per second,
+ *          the queue depths, and the latency percentiles of each instance
+ *          size, and writes them all to a Prometheus text file.
+ * @version 1.0
+ * @date 2019-06-18
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <new>
+
+#include "Metrics.h"
+
+using namespace std;
+
+atomic<bool> Metrics::enabled(false);
+atomic<int>  Metrics::claimed(0);
+atomic<ThreadMetrics*> Metrics::slots[METRIC_THREADS];
+
+// the label of each instance size
+static const char* SIZE_LABELS[METRIC_SIZES] = { "20", "50", "100", "200", "500", "more" };
+
+// the name of each counter in the Prometheus file
+static const char* COUNTER_METRICS[METRIC_COUNTERS] = {
+    "flowshop_evaluations_total", "flowshop_tasks_total", "flowshop_tasks_cached_total", "flowshop_tasks_aborted_total"
+};
+
+/**
+ * @brief Construct a new Metrics:: Metrics object. Nothing is recorded until
+ *          it is started.
+ *
+ */
+Metrics::Metrics()
+{
+    interval = 5;
+    done     = false;
+    memset(&last, 0, sizeof(last));
+}
+
+/**
+ * @brief Destroy the Metrics:: Metrics object, stopping the reporter
+ *
+ */
+Metrics::~Metrics()
+{
+    stop();
+}
+
+/**
+ * @brief Starts recording and the reporter thread
+ *
+ * @param prometheus    The Prometheus text file to write, or "none"
+ * @param seconds       How often to report
+ * @return true         If metrics are on
+ */
+bool Metrics::start(const string prometheus, const int seconds)
+{
+    if (prometheus.empty() || prometheus == "none")
+        return false;
+
+    path      = prometheus;
+    interval  = max(1, seconds);
+    done      = false;
+    startTime = chrono::steady_clock::now();
+    lastTime  = startTime;
+    snapshot(&last);
+
+    enabled = true;
+    reporter = thread(&Metrics::run, this);
+    return true;
+}
+
+/**
+ * @brief Adds a queue whose depth is reported. Add them before the batch
+ *          starts, the reporter reads the list without a lock.
+ *
+ * @param name      The name of the queue, such as "pool"
+ * @param sample    Returns how many items are in the queue
+ */
+void Metrics::addGauge(const string name, function<size_t()> sample)
+{
+    unique_lock<mutex> lock(reportMutex);
+    gauges.push_back(make_pair(name, sample));
+}
+
+/**
+ * @brief Stops recording, makes the last report, and stops the reporter
+ *
+ */
+void Metrics::stop()
+{
+    if (!reporter.joinable())
+        return;
+
+    {
+        unique_lock<mutex> lock(reportMutex);
+        done = true;
+    }
+    wake.notify_all();
+    reporter.join();
+
+    enabled = false;
+    report(true);
+    gauges.clear();
+}
+
+/**
+ * @brief Stops every thread recording, without a report. Used by forked
+ *          worker processes, which have no reporter of their own.
+ *
+ */
+void Metrics::stopRecording()
+{
+    enabled = false;
+}
+
+/**
+ * @brief The loop of the reporter thread
+ *
+ */
+void Metrics::run()
+{
+    unique_lock<mutex> lock(reportMutex);
+
+    while (!done)
+    {
+        if (wake.wait_for(lock, chrono::seconds(interval), [this] { return done; }))
+            break;
+
+        lock.unlock();
+        report(false);
+        lock.lock();
+    }
+}
+
+/**
+ * @brief Returns the counters of the calling thread, claiming a slot the
+ *          first time a thread records anything
+ *
+ * @return ThreadMetrics* The counters of the thread
+ */
+ThreadMetrics* Metrics::forThread()
+{
+    static thread_local ThreadMetrics* mine = nullptr;
+    if (mine != nullptr)
+        return mine;
+
+    int slot = min(claimed.load(), METRIC_THREADS - 1);
+    if (slot < METRIC_THREADS - 1)
+        slot = min(claimed++, METRIC_THREADS - 1);
+
+    // the last slot is shared by every thread past the limit
+    ThreadMetrics* metrics = slots[slot].load();
+    if (metrics == nullptr)
+    {
+        void* memory = nullptr;
+        if (posix_memalign(&memory, alignof(ThreadMetrics), sizeof(ThreadMetrics)) != 0)
+            abort();
+        memset(memory, 0, sizeof(ThreadMetrics));
+
+        ThreadMetrics* fresh = new (memory) ThreadMetrics;
+        if (slots[slot].compare_exchange_strong(metrics, fresh))
+            metrics = fresh;
+        else
+            free(memory);
+    }
+
+    mine = metrics;
+    return mine;
+}
+
+/**
+ * @brief Adds one to a counter of the calling thread
+ *
+ * @param counter The counter (METRIC_*)
+ */
+void Metrics::count(const int counter)
+{
+    if (!isEnabled())
+        return;
+
+    forThread()->counters[counter].fetch_add(1, memory_order_relaxed);
+}
+
+/**
+ * @brief Counts one evaluation and adds its time to the histogram of its
+ *          instance size
+ *
+ * @param jobs  The number of jobs of the instance
+ * @param nanos How long the evaluation took (ns)
+ */
+void Metrics::recordEvaluation(const int jobs, const uint64_t nanos)
+{
+    ThreadMetrics* metrics = forThread();
+    metrics->counters[METRIC_EVALUATIONS].fetch_add(1, memory_order_relaxed);
+    metrics->latency[sizeOf(jobs)][bucketOf(nanos)].fetch_add(1, memory_order_relaxed);
+}
+
+/**
+ * @brief Returns the histogram bucket of a time
+ *
+ * @param nanos The time (ns)
+ * @return int  The bucket
+ */
+int Metrics::bucketOf(const uint64_t nanos)
+{
+    const uint64_t sub = 1 << METRIC_SUB_BITS;
+    if (nanos < sub)
+        return nanos;
+
+    int power = 63 - __builtin_clzll(nanos);
+    int bucket = sub + (power - METRIC_SUB_BITS) * sub + ((nanos >> (power - METRIC_SUB_BITS)) - sub);
+    return min(bucket, METRIC_BUCKETS - 1);
+}
+
+/**
+ * @brief Returns the first time past a bucket
+ *
+ * @param bucket        The bucket
+ * @return uint64_t     Its upper limit (ns)
+ */
+uint64_t Metrics::bucketLimit(const int bucket)
+{
+    const int sub = 1 << METRIC_SUB_BITS;
+    int next = bucket + 1;
+    if (next < sub)
+        return next;
+
+    int power = (next - sub) / sub + METRIC_SUB_BITS;
+    return (uint64_t)(sub + (next - sub) % sub) << (power - METRIC_SUB_BITS);
+}
+
+/**
+ * @brief Returns the size class of an instance
+ *
+ * @param jobs  The number of jobs
+ * @return int  The size class
+ */
+int Metrics::sizeOf(const int jobs)
+{
+    if (jobs <= 20)  return 0;
+    if (jobs <= 50)  return 1;
+    if (jobs <= 100) return 2;
+    if (jobs <= 200) return 3;
+    if (jobs <= 500) return 4;
+    return 5;
+}
+
+/**
+ * @brief Adds up the metrics of every thread. The counters keep moving while
+ *          they are read, so the sum is close to, not exactly, one moment.
+ *
+ * @param snap Receives the sums
+ */
+void Metrics::snapshot(MetricsSnapshot* snap)
+{
+    memset(snap, 0, sizeof(*snap));
+
+    int used = min(claimed.load(), METRIC_THREADS);
+    for (int t = 0; t < used; ++t)
+    {
+        ThreadMetrics* metrics = slots[t].load();
+        if (metrics == nullptr)
+            continue;
+
+        for (int c = 0; c < METRIC_COUNTERS; ++c)
+            snap->counters[c] += metrics->counters[c].load(memory_order_relaxed);
+
+        for (int s = 0; s < METRIC_SIZES; ++s)
+            for (int b = 0; b < METRIC_BUCKETS; ++b)
+                snap->latency[s][b] += metrics->latency[s][b].load(memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief Returns a percentile of a histogram
+ *
+ * @param latency       The buckets
+ * @param total         How many times are in the buckets
+ * @param fraction      The percentile, such as 0.99
+ * @return uint64_t     The upper limit of the bucket holding it (ns)
+ */
+static uint64_t percentile(const uint64_t* latency, const uint64_t total, const double fraction)
+{
+    uint64_t rank = (uint64_t)(fraction * total + 0.5), seen = 0;
+    for (int b = 0; b < METRIC_BUCKETS; ++b)
+    {
+        seen += latency[b];
+        if (seen >= max(rank, (uint64_t)1))
+            return Metrics::bucketLimit(b);
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Prints the rates since the last report and writes the Prometheus
+ *          file
+ *
+ * @param final Whether this is the report at the end of the batch
+ */
+void Metrics::report(const bool final)
+{
+    MetricsSnapshot* now = new MetricsSnapshot;
+    snapshot(now);
+
+    chrono::steady_clock::time_point time = chrono::steady_clock::now();
+    double seconds = chrono::duration<double>(time - (final ? startTime : lastTime)).count();
+    uint64_t evals = now->counters[METRIC_EVALUATIONS] - (final ? 0 : last.counters[METRIC_EVALUATIONS]);
+    double rate = (seconds > 0) ? evals / seconds : 0;
+
+    // the coordinator counts no evaluations, its workers do them
+    cout << "Metrics: ";
+    if (now->counters[METRIC_EVALUATIONS] > 0)
+        cout << (uint64_t)rate << " evaluations/s" << (final ? " over the batch" : "") << ", ";
+    cout << now->counters[METRIC_TASKS] << " task(s) done";
+    if (now->counters[METRIC_CACHED] > 0)  cout << ", " << now->counters[METRIC_CACHED] << " cached";
+    if (now->counters[METRIC_ABORTED] > 0) cout << ", " << now->counters[METRIC_ABORTED] << " aborted";
+    for (size_t g = 0; g < gauges.size() && !final; ++g)
+        cout << ", " << gauges[g].first << " queue " << gauges[g].second();
+    cout << "\n";
+
+    // the latency of the evaluations since the last report, by instance size
+    for (int s = 0; s < METRIC_SIZES; ++s)
+    {
+        uint64_t recent[METRIC_BUCKETS], total = 0;
+        for (int b = 0; b < METRIC_BUCKETS; ++b)
+        {
+            recent[b] = now->latency[s][b] - (final ? 0 : last.latency[s][b]);
+            total += recent[b];
+        }
+        if (total == 0)
+            continue;
+
+        cout << "  up to " << SIZE_LABELS[s] << " jobs: " << total << " evaluation(s), p50 ";
+        cout << percentile(recent, total, 0.5) / 1000.0 << " us, p90 " << percentile(recent, total, 0.9) / 1000.0;
+        cout << " us, p99 " << percentile(recent, total, 0.99) / 1000.0 << " us, max ";
+        cout << percentile(recent, total, 1.0) / 1000.0 << " us\n";
+    }
+
+    writeFile(now, rate);
+
+    last     = *now;
+    lastTime = time;
+    delete now;
+}
+
+/**
+ * @brief Writes the metrics in the Prometheus text format. The file is
+ *          written beside its path and renamed, so a scraper never reads
+ *          half of it.
+ *
+ * @param snap  The sums of every thread
+ * @param rate  The evaluations per second since the last report
+ */
+void Metrics::writeFile(MetricsSnapshot* snap, const double rate)
+{
+    buffer.clear();
+
+    for (int c = 0; c < METRIC_COUNTERS; ++c)
+    {
+        buffer.putString("# TYPE "); buffer.putString(COUNTER_METRICS[c]); buffer.putString(" counter\n");
+        buffer.putString(COUNTER_METRICS[c]); buffer.putChar(' ');
+        buffer.putInt(snap->counters[c]); buffer.putChar('\n');
+    }
+
+    buffer.putString("# TYPE flowshop_evaluations_per_second gauge\nflowshop_evaluations_per_second ");
+    buffer.putDouble(rate); buffer.putChar('\n');
+
+    if (!gauges.empty())
+        buffer.putString("# TYPE flowshop_queue_depth gauge\n");
+    for (size_t g = 0; g < gauges.size(); ++g)
+    {
+        buffer.putString("flowshop_queue_depth{queue=\""); buffer.putString(gauges[g].first.c_str());
+        buffer.putString("\"} "); buffer.putInt(gauges[g].second()); buffer.putChar('\n');
+    }
+
+    // the histogram, with a bucket at each power of two nanoseconds
+    buffer.putString("# TYPE flowshop_evaluation_seconds histogram\n");
+    for (int s = 0; s < METRIC_SIZES; ++s)
+    {
+        uint64_t total = 0;
+        double sum = 0;
+        for (int b = 0; b < METRIC_BUCKETS; ++b)
+        {
+            total += snap->latency[s][b];
+            sum   += snap->latency[s][b] * (double)bucketLimit(b) * 1e-9;
+        }
+        if (total == 0)
+            continue;
+
+        uint64_t below = 0;
+        int b = 0;
+        for (int power = 0; power < 42; ++power)
+        {
+            uint64_t limit = (uint64_t)1 << power;
+            while (b < METRIC_BUCKETS && bucketLimit(b) <= limit)
+                below += snap->latency[s][b++];
+
+            char le[32];
+            snprintf(le, sizeof(le), "%.9g", limit * 1e-9);
+            buffer.putString("flowshop_evaluation_seconds_bucket{jobs=\""); buffer.putString(SIZE_LABELS[s]);
+            buffer.putString("\",le=\""); buffer.putString(le); buffer.putString("\"} ");
+            buffer.putInt(below); buffer.putChar('\n');
+        }
+
+        buffer.putString("flowshop_evaluation_seconds_bucket{jobs=\""); buffer.putString(SIZE_LABELS[s]);
+        buffer.putString("\",le=\"+Inf\"} "); buffer.putInt(total); buffer.putChar('\n');
+        buffer.putString("flowshop_evaluation_seconds_sum{jobs=\""); buffer.putString(SIZE_LABELS[s]);
+        buffer.putString("\"} "); buffer.putDouble(sum); buffer.putChar('\n');
+        buffer.putString("flowshop_evaluation_seconds_count{jobs=\""); buffer.putString(SIZE_LABELS[s]);
+        buffer.putString("\"} "); buffer.putInt(total); buffer.putChar('\n');
+    }
+
+    string temp = path + ".tmp";
+    if (!buffer.writeFile(temp.c_str()) || rename(temp.c_str(), path.c_str()) != 0)
+        cout << "Could not write the metrics file " << path << "\n";
+}
@@ -0,0 +1,134 @@
+/**
+ * @file Options.cpp
+ * @author Matthew Harker
+ * @brief Reads the optional "key value" settings from options.txt. These
+ *          are the tuning knobs that do not fit the fixed line layout of
+ *          parameters.txt.
+ * @version 1.0
+ * @date 2019-06-03
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "Options.h"
+
+using namespace std;
+
+/**
+ * @brief Construct a new Options:: Options object
+ *
+ */
+Options::Options()
+{
+}
+
+/**
+ * @brief Reads in the options file. Every line before the first blank line
+ *          holds one "key value" pair, everything after it is documentation.
+ *
+ * @param path  The path of the options file
+ * @return true  If the file was found and read
+ * @return false If the file could not be opened
+ */
+bool Options::load(const string path)
+{
+    ifstream file(path);
+    if (!file.is_open())
+        return false;
+
+    string line;
+    while (getline(file, line))
+    {
+        // the settings end at the first blank line
+        if (line.find_first_not_of(" \t\r") == string::npos)
+            break;
+
+        // split the line into its key and value
+        istringstream iss(line);
+        string key, value;
+        iss >> key >> value;
+        values[key] = value;
+    }
+
+    file.close();
+    return true;
+}
+
+/**
+ * @brief Sets (or overrides) the value of a key
+ *
+ * @param key   The name of the option
+ * @param value The new value of the option
+ */
+void Options::set(const string key, const string value)
+{
+    values[key] = value;
+}
+
+/**
+ * @brief Returns whether a key was given a value
+ *
+ * @param key   The name of the option
+ * @return true If the option was set
+ */
+bool Options::has(const string key)
+{
+    return values.find(key) != values.end();
+}
+
+/**
+ * @brief Returns the value of an option as a string
+ *
+ * @param key       The name of the option
+ * @param fallback  The value to use if the option was not set
+ * @return string   The value of the option
+ */
+string Options::getString(const string key, const string fallback)
+{
+    map<string, string>::iterator it = values.find(key);
+    if (it == values.end())
+        return fallback;
+
+    return it->second;
+}
+
+/**
+ * @brief Returns the value of an option as an integer
+ *
+ * @param key       The name of the option
+ * @param fallback  The value to use if the option was not set or is not a number
+ * @return int      The value of the option
+ */
+int Options::getInt(const string key, const int fallback)
+{
+    map<string, string>::iterator it = values.find(key);
+    if (it == values.end())
+        return fallback;
+
+    // make sure the whole value is a number
+    istringstream iss(it->second);
+    int val;
+    if (!(iss >> val))
+    {
+        cout << "Option \"" << key << "\" is not a number, using " << fallback << "\n";
+        return fallback;
+    }
+
+    return val;
+}
+
+/**
+ * @brief Returns the options shared by the whole program
+ *
+ * @return Options* The program wide options
+ */
+Options* getOptions()
+{
+    static Options options;
+    return &options;
+}
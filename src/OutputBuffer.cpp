@@ -0,0 +1,212 @@
+/**
+ * @file OutputBuffer.cpp
+ * @author Matthew Harker
+ * @brief A reusable buffer for formatting output files without streams,
+ *          written to disk with one system call per file.
+ * @version 1.0
+ * @date 2019-06-10
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "OutputBuffer.h"
+
+using namespace std;
+
+/**
+ * @brief Construct a new OutputBuffer:: OutputBuffer object
+ *
+ */
+OutputBuffer::OutputBuffer()
+{
+    len = 0;
+}
+
+/**
+ * @brief Makes room for more bytes at the end of the buffer
+ *
+ * @param bytes How many bytes will be added
+ * @return char* Where they go
+ */
+char* OutputBuffer::reserve(const size_t bytes)
+{
+    if (len + bytes > buf.size())
+        buf.resize(max(buf.size() * 2, len + bytes + 4096));
+
+    return buf.data() + len;
+}
+
+/**
+ * @brief Empties the buffer, keeping its memory
+ *
+ */
+void OutputBuffer::clear()
+{
+    len = 0;
+}
+
+/**
+ * @brief Adds one character
+ *
+ * @param c The character
+ */
+void OutputBuffer::putChar(const char c)
+{
+    *reserve(1) = c;
+    ++len;
+}
+
+/**
+ * @brief Adds a string
+ *
+ * @param str The string, without its terminating null
+ */
+void OutputBuffer::putString(const char* str)
+{
+    size_t n = strlen(str);
+    memcpy(reserve(n), str, n);
+    len += n;
+}
+
+/**
+ * @brief Adds an integer in decimal
+ *
+ * @param val The integer
+ */
+void OutputBuffer::putInt(const long long val)
+{
+    char* start = reserve(20);
+    len += formatInt(start, val) - start;
+}
+
+/**
+ * @brief Adds a floating point number the way an ostream prints it by
+ *          default (six significant digits)
+ *
+ * @param val The number
+ */
+void OutputBuffer::putDouble(const double val)
+{
+    char* start = reserve(32);
+    len += snprintf(start, 32, "%g", val);
+}
+
+/**
+ * @brief Adds raw bytes, for binary files
+ *
+ * @param bytes The bytes
+ * @param count How many bytes to add
+ */
+void OutputBuffer::putBytes(const void* bytes, const size_t count)
+{
+    memcpy(reserve(count), bytes, count);
+    len += count;
+}
+
+/**
+ * @brief Pads the buffer with zeros up to a multiple of a boundary
+ *
+ * @param boundary The boundary in bytes
+ */
+void OutputBuffer::align(const size_t boundary)
+{
+    size_t pad = (boundary - len % boundary) % boundary;
+    memset(reserve(pad), 0, pad);
+    len += pad;
+}
+
+/**
+ * @brief Returns the contents of the buffer
+ *
+ * @return const char* The first byte
+ */
+const char* OutputBuffer::data()
+{
+    return buf.data();
+}
+
+/**
+ * @brief Returns how many bytes are in the buffer
+ *
+ * @return size_t The number of bytes
+ */
+size_t OutputBuffer::size()
+{
+    return len;
+}
+
+/**
+ * @brief Replaces a file with the contents of the buffer
+ *
+ * @param pathname  The file to write
+ * @return true     If the whole buffer was written
+ */
+bool OutputBuffer::writeFile(const char* pathname)
+{
+    int fd = open(pathname, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+        return false;
+
+    bool written = writeTo(fd);
+    return (close(fd) == 0) && written;
+}
+
+/**
+ * @brief Writes the contents to the end of an open file, so a file too large
+ *          to hold in memory can be written one buffer at a time
+ *
+ * @param fd    The open file
+ * @return true If every byte was written
+ */
+bool OutputBuffer::writeTo(const int fd)
+{
+    // one write is almost always enough, the loop handles partial writes
+    size_t done = 0;
+    while (done < len)
+    {
+        ssize_t n = write(fd, buf.data() + done, len - done);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            break;
+
+        done += n;
+    }
+
+    return done == len;
+}
+
+/**
+ * @brief Writes an integer in decimal, without a terminating null
+ *
+ * @param dst   Where to write it, room for 20 characters is enough
+ * @param val   The integer
+ * @return char* One past the last character written
+ */
+char* OutputBuffer::formatInt(char* dst, long long val)
+{
+    unsigned long long num = (val < 0) ? 0ULL - (unsigned long long)val : val;
+    if (val < 0)
+        *dst++ = '-';
+
+    // the digits come out backwards
+    char digits[20];
+    int n = 0;
+    do
+    {
+        digits[n++] = '0' + num % 10;
+        num /= 10;
+    } while (num > 0);
+
+    while (n > 0)
+        *dst++ = digits[--n];
+
+    return dst;
+}
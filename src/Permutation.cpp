@@ -8,9 +8,11 @@
  * @copyright Copyright (c) 2019
  * 
  */
+#include <algorithm>
 #include <climits>
 #include <iostream>
 
+#include "Allocations.h"
 #include "Permutation.h"
 
 using namespace std;
@@ -29,13 +31,13 @@ Permutation::Permutation(const int s)
     bestVal = INT_MAX;
 
     // set up perm and best arrays
-    perm = new int[size];
-    best = new int[size];
+    perm = Allocations::allocate<int>(size);
+    best = Allocations::allocate<int>(size);
 
     // set up allJobs matrix 
-    allJobs = new int*[2];
+    allJobs = Allocations::allocate<int*>(2);
     for (int i = 0; i < 2; ++i)
-        allJobs[i] = new int[size];
+        allJobs[i] = Allocations::allocate<int>(size);
 }
 
 /**
@@ -44,7 +46,12 @@ Permutation::Permutation(const int s)
  */
 Permutation::~Permutation()
 {
-    delete[] perm;
+    Allocations::release(perm, size);
+    Allocations::release(best, size);
+
+    for (int i = 0; i < 2; ++i)
+        Allocations::release(allJobs[i], size);
+    Allocations::release(allJobs, 2);
 }
 
 /**
@@ -203,21 +210,30 @@ int* Permutation::getPerm()
 }
 
 /**
- * @brief Resizes the perm array
+ * @brief Resizes the arrays of the permutation, keeping the elements that
+ *          still fit
  * 
- * @param newSize The new size of the perm array
+ * @param newSize The new size of the arrays
  */
 void Permutation::resize(const int newSize)
 {
-    // change the value of size
-    size = newSize;
+    int kept = min(size, newSize);
 
-    // create a new array of the new size, and change perm's pointer to that
-    int* temp = new int[size];
-    perm = temp;
+    // move each array into one of the new size
+    int** arrays[] = { &perm, &best, &allJobs[0], &allJobs[1] };
+    for (int a = 0; a < 4; ++a)
+    {
+        int* temp = Allocations::allocate<int>(newSize);
+        copy(*arrays[a], *arrays[a] + kept, temp);
+
+        Allocations::release(*arrays[a], size);
+        *arrays[a] = temp;
+    }
 
-    // delete the temp array
-    delete[] temp;
+    // change the value of size, and drop the elements past it
+    size    = newSize;
+    curSize = min(curSize, size);
+    pos     = min(pos, max(curSize - 1, 0));
 }
 
 /**
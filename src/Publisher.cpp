@@ -0,0 +1,186 @@
+/**
+ * @file Publisher.cpp
+ * @author Matthew Harker
+ * @brief Publishes every finished result into a POSIX shared memory ring,
+ *          so local monitoring processes see results as they finish
+ *          instead of polling the results directories.
+ * @version 1.0
+ * @date 2019-06-13
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+#include "Publisher.h"
+
+using namespace std;
+
+/**
+ * @brief Construct a new Publisher:: Publisher object
+ *
+ */
+Publisher::Publisher()
+{
+    mapping   = nullptr;
+    size      = 0;
+    header    = nullptr;
+    slots     = nullptr;
+    published = 0;
+}
+
+/**
+ * @brief Destroy the Publisher:: Publisher object. The segment is left in
+ *          place so readers can still see the last results.
+ *
+ */
+Publisher::~Publisher()
+{
+    close();
+}
+
+/**
+ * @brief Marks the segment a name refers to as retired, so its readers
+ *          follow the next one made under the name. Only the header is
+ *          mapped and nothing is resized, readers keep their mappings.
+ *
+ * @param segment The name of the segment
+ */
+static void retire(const string segment)
+{
+    int fd = shm_open(segment.c_str(), O_RDWR, 0);
+    if (fd < 0)
+        return;
+
+    struct stat info;
+    void* mapped = (fstat(fd, &info) == 0 && (size_t)info.st_size >= sizeof(RingHeader)) ?
+        mmap(nullptr, sizeof(RingHeader), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+    ::close(fd);
+
+    if (mapped == MAP_FAILED)
+        return;
+
+    RingHeader* old = static_cast<RingHeader*>(mapped);
+    if (memcmp(old->magic, RING_MAGIC, 4) == 0)
+        old->retired.store(1, memory_order_release);
+    munmap(mapped, sizeof(RingHeader));
+}
+
+/**
+ * @brief Creates a fresh segment under the name. A segment an earlier batch
+ *          left there is retired and unlinked rather than cleared, since
+ *          shrinking memory a reader has mapped would crash the reader.
+ *
+ * @param segment   The name of the segment, such as "/flowshop"
+ * @param slotCount How many records the ring holds before it wraps
+ * @return true     If the ring is ready
+ */
+bool Publisher::open(const string segment, const int slotCount)
+{
+    close();
+
+    name = segment;
+    uint32_t count = (slotCount > 0) ? slotCount : 1024;
+
+    retire(name);
+    shm_unlink(name.c_str());
+
+    int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+    if (fd < 0)
+    {
+        cout << "Shared memory " << name << " could not be created, results will not be published\n";
+        return false;
+    }
+
+    // a new segment is all zeros, so readers see no slots until it is set up
+    size = sizeof(RingHeader) + (size_t)count * RING_SLOT_SIZE;
+    bool ok = ftruncate(fd, size) == 0;
+    void* mapped = ok ? mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+    ::close(fd);
+
+    if (mapped == MAP_FAILED)
+    {
+        cout << "Shared memory " << name << " could not be mapped, results will not be published\n";
+        shm_unlink(name.c_str());
+        return false;
+    }
+
+    mapping = mapped;
+    header  = static_cast<RingHeader*>(mapping);
+    slots   = reinterpret_cast<RingSlot*>(static_cast<char*>(mapping) + sizeof(RingHeader));
+
+    header->version  = RING_VERSION;
+    header->slotSize = RING_SLOT_SIZE;
+    header->head.store(0, memory_order_relaxed);
+    header->retired.store(0, memory_order_relaxed);
+
+    // then the shape of the ring, and the magic last, a reader never sees a
+    // half made header
+    atomic_thread_fence(memory_order_release);
+    header->slotCount = count;
+    header->epoch     = chrono::steady_clock::now().time_since_epoch().count();
+    atomic_thread_fence(memory_order_release);
+    memcpy(header->magic, RING_MAGIC, 4);
+
+    published = 0;
+    return true;
+}
+
+/**
+ * @brief Publishes one result. Never waits for readers: the oldest record
+ *          is written over once the ring is full.
+ *
+ * @param res The result
+ */
+void Publisher::publish(Result* res)
+{
+    if (mapping == nullptr)
+        return;
+
+    uint64_t n = header->head.load(memory_order_relaxed);
+    RingSlot& slot = slots[n % header->slotCount];
+
+    // mark the slot as being written
+    slot.seq.store(2 * n + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    RingRecord& rec  = slot.record;
+    rec.datafile     = res->datafile;
+    rec.alg          = res->alg;
+    rec.cmax         = res->cmax;
+    rec.originalCmax = res->mem.getOriginalCmax();
+    rec.funcCalls    = res->mem.getFuncCalls();
+    rec.timeTaken    = res->mem.getTimeTaken();
+    rec.jobs         = res->sequence.size();
+    rec.stored       = min<size_t>(res->sequence.size(), RING_MAX_JOBS);
+    rec.reserved     = 0;
+    memcpy(rec.sequence, res->sequence.data(), rec.stored * sizeof(int32_t));
+
+    // then as finished, and only then move the head past it
+    slot.seq.store(2 * n + 2, memory_order_release);
+    header->head.store(n + 1, memory_order_release);
+    ++published;
+}
+
+/**
+ * @brief Unmaps the segment
+ *
+ */
+void Publisher::close()
+{
+    if (mapping != nullptr)
+        munmap(mapping, size);
+
+    mapping = nullptr;
+}
+
+/**
+ * @brief Prints how many results were published and where
+ *
+ */
+void Publisher::report()
+{
+    cout << "Publisher: " << published << " result(s) published to " << name << "\n";
+}
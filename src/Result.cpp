@@ -0,0 +1,96 @@
+/**
+ * @file Result.cpp
+ * @author Matthew Harker
+ * @brief Converts Result records to and from a single line of text, which
+ *          is how they travel between processes.
+ * @version 1.0
+ * @date 2019-06-07
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+#include <sstream>
+#include <string>
+
+#include "Result.h"
+
+using namespace std;
+
+/**
+ * @brief Writes a record as one line of text (without the newline):
+ *          datafile alg cmax originalCmax funcCalls timeTaken jobs sequence... phases... counts... allocations...
+ *          The phase times, counts, and allocations go last so lines written
+ *          before they existed can still be read.
+ *
+ * @param res       The record to write
+ * @return string   The line of text
+ */
+string resultToLine(Result* res)
+{
+    ostringstream oss;
+    oss << res->datafile << " " << res->alg << " " << res->cmax << " " << res->mem.getOriginalCmax() << " ";
+    oss << res->mem.getFuncCalls() << " " << res->mem.getTimeTaken() << " ";
+    oss << res->sequence.size();
+
+    for (size_t i = 0; i < res->sequence.size(); ++i)
+        oss << " " << res->sequence[i];
+
+    for (int p = 0; p < PHASE_COUNT; ++p)
+        oss << " " << res->mem.getPhaseTime(p);
+    for (int c = 0; c < COUNTER_COUNT; ++c)
+        oss << " " << res->mem.getCount(c);
+    for (int a = 0; a < ALLOC_STATS; ++a)
+        oss << " " << res->mem.getAllocation(a);
+
+    return oss.str();
+}
+
+/**
+ * @brief Reads a record back from a line made by resultToLine(). The record
+ *          will not have a job matrix.
+ *
+ * @param line  The line of text
+ * @param res   The record to fill in
+ * @return true If the whole line was read
+ */
+bool resultFromLine(const string line, Result* res)
+{
+    istringstream iss(line);
+
+    int original, calls;
+    double time;
+    size_t size;
+    if (!(iss >> res->datafile >> res->alg >> res->cmax >> original >> calls >> time >> size))
+        return false;
+
+    res->mem = Memory();
+    res->mem.setOriginalCmax(original);
+    res->mem.addFuncCalls(calls);
+    res->mem.setTimeTaken(time);
+
+    res->sequence.resize(size);
+    for (size_t i = 0; i < size; ++i)
+        if (!(iss >> res->sequence[i]))
+            return false;
+
+    // older lines have no phase times, counts, or allocations
+    double phase;
+    for (int p = 0; p < PHASE_COUNT && iss >> phase; ++p)
+        res->mem.setPhaseTime(p, phase);
+
+    long long counts[COUNTER_COUNT];
+    int known = 0;
+    while (known < COUNTER_COUNT && iss >> counts[known])
+        ++known;
+    if (known == COUNTER_COUNT)
+        res->mem.setCounts(counts);
+
+    long long allocs[ALLOC_STATS];
+    known = 0;
+    while (known < ALLOC_STATS && iss >> allocs[known])
+        ++known;
+    if (known == ALLOC_STATS)
+        res->mem.setAllocations(allocs);
+
+    return true;
+}
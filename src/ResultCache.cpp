@@ -0,0 +1,294 @@
+/**
+ * @file ResultCache.cpp
+ * @author Matthew Harker
+ * @brief A content addressed cache of results, so re-running a batch only
+ *          solves what changed, identical instances are solved once, and a
+ *          stopped batch picks up where it left off.
+ * @version 1.0
+ * @date 2019-06-12
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+#include <atomic>
+#include <cstdio>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "OutputBuffer.h"
+#include "ResultCache.h"
+
+using namespace std;
+
+// FNV-1a, 64 bit
+static const uint64_t FNV_OFFSET = 14695981039346656037ULL;
+static const uint64_t FNV_PRIME  = 1099511628211ULL;
+
+/**
+ * @brief Adds bytes to an FNV-1a hash
+ *
+ * @param hash      The hash so far
+ * @param bytes     The bytes to add
+ * @param count     How many bytes there are
+ * @return uint64_t The new hash
+ */
+static uint64_t fnv(uint64_t hash, const void* bytes, const size_t count)
+{
+    const unsigned char* p = static_cast<const unsigned char*>(bytes);
+    for (size_t i = 0; i < count; ++i)
+    {
+        hash ^= p[i];
+        hash *= FNV_PRIME;
+    }
+
+    return hash;
+}
+
+/**
+ * @brief Construct a new ResultCache:: ResultCache object. Creates the
+ *          directory if needed and resumes the manifest of an interrupted
+ *          batch if it was made with the same settings.
+ *
+ * @param dir               Where the results are kept
+ * @param solverSettings    Everything besides the instance and algorithm that
+ *                              changes a result, such as the decomposition
+ * @param useManifest       Whether this process keeps the batch's manifest
+ *                              (only one process of a batch may)
+ */
+ResultCache::ResultCache(const string dir, const string solverSettings, const bool useManifest)
+{
+    directory    = dir;
+    settings     = solverSettings;
+    manifestPath = directory + "/manifest.txt";
+    hits         = 0;
+    misses       = 0;
+    resumed      = 0;
+    waits        = 0;
+    manifest     = -1;
+
+    mkdir(directory.c_str(), 0755);
+    if (!useManifest)
+        return;
+
+    // an interrupted batch left its manifest behind
+    ifstream old(manifestPath);
+    string line;
+    bool same = old.is_open() && getline(old, line) && line == "settings " + settings;
+    while (same && getline(old, line))
+    {
+        istringstream iss(line);
+        int datafile, alg;
+        uint64_t key;
+        if (iss >> datafile >> alg >> hex >> key)
+            finished[make_pair(datafile, alg)] = key;
+    }
+    old.close();
+
+    // keep adding to it, or start a new one
+    if (same)
+    {
+        manifest = open(manifestPath.c_str(), O_WRONLY | O_APPEND);
+    }
+    else
+    {
+        manifest = open(manifestPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0644);
+        string header = "settings " + settings + "\n";
+        if (manifest >= 0 && write(manifest, header.data(), header.size()) < 0)
+            cout << "Could not write the cache manifest " << manifestPath << "\n";
+    }
+
+    if (manifest < 0)
+        cout << "Could not open the cache manifest " << manifestPath << ", the batch can't be resumed\n";
+    if (!finished.empty())
+        cout << "Cache: resuming a batch with " << finished.size() << " finished task(s)\n";
+}
+
+/**
+ * @brief Destroy the ResultCache:: ResultCache object
+ *
+ */
+ResultCache::~ResultCache()
+{
+    if (manifest >= 0)
+        close(manifest);
+}
+
+/**
+ * @brief Hashes an instance's contents, the algorithm, and the solver settings
+ *
+ * @param jobs      The matrix of job run times
+ * @param alg       The FSS algorithm
+ * @return uint64_t The key of the result
+ */
+uint64_t ResultCache::makeKey(Matrix* jobs, const int alg)
+{
+    int rows = jobs->getRows();
+    int cols = jobs->getCols();
+
+    uint64_t hash = fnv(FNV_OFFSET, settings.data(), settings.size());
+    hash = fnv(hash, &alg,  sizeof(alg));
+    hash = fnv(hash, &rows, sizeof(rows));
+    hash = fnv(hash, &cols, sizeof(cols));
+    for (int r = 0; r < rows; ++r)
+        hash = fnv(hash, jobs->getRow(r), cols * sizeof(int));
+
+    return hash;
+}
+
+/**
+ * @brief Looks a result up. If another task is solving the same key right
+ *          now, waits for it first. On a miss the caller must solve the
+ *          task and store() the result.
+ *
+ * @param datafile  The datafile of the task
+ * @param key       The key of the result
+ * @param res       Receives the cached result (without its job matrix)
+ * @return true     If the result was cached
+ */
+bool ResultCache::acquire(const int datafile, const uint64_t key, Result* res)
+{
+    unique_lock<mutex> lock(cacheMutex);
+
+    // an identical instance is being solved, use its result
+    if (running.count(key) > 0)
+    {
+        ++waits;
+        solved.wait(lock, [this, key] { return running.count(key) == 0; });
+    }
+
+    if (readEntry(key, res))
+    {
+        // the entry may have been solved under another datafile number
+        res->datafile = datafile;
+        record(res, key);
+        ++hits;
+        return true;
+    }
+
+    running.insert(key);
+    ++misses;
+    return false;
+}
+
+/**
+ * @brief Stores a solved result and lets any task waiting for it continue
+ *
+ * @param key   The key of the result
+ * @param res   The result
+ */
+void ResultCache::store(const uint64_t key, Result* res)
+{
+    // write a temporary file and rename it, so a reader never sees half of it
+    static atomic<long> serial(0);
+    string path = entryPath(key);
+    string temp = path + ".tmp" + to_string(getpid()) + "-" + to_string(serial++);
+
+    OutputBuffer out;
+    out.putString(resultToLine(res).c_str());
+    out.putChar('\n');
+    if (!out.writeFile(temp.c_str()) || rename(temp.c_str(), path.c_str()) != 0)
+    {
+        cout << "Could not write the cache entry " << path << "\n";
+        unlink(temp.c_str());
+    }
+
+    {
+        unique_lock<mutex> lock(cacheMutex);
+        running.erase(key);
+        record(res, key);
+    }
+    solved.notify_all();
+}
+
+/**
+ * @brief Finds a task the interrupted batch already finished
+ *
+ * @param datafile  The datafile of the task
+ * @param alg       The algorithm of the task
+ * @param res       Receives the result (without its job matrix)
+ * @return true     If the task can be skipped
+ */
+bool ResultCache::resume(const int datafile, const int alg, Result* res)
+{
+    unique_lock<mutex> lock(cacheMutex);
+
+    map< pair<int, int>, uint64_t >::iterator it = finished.find(make_pair(datafile, alg));
+    if (it == finished.end() || !readEntry(it->second, res))
+        return false;
+
+    res->datafile = datafile;
+    ++resumed;
+    return true;
+}
+
+/**
+ * @brief Marks the batch as complete, so the next one starts over
+ *
+ */
+void ResultCache::complete()
+{
+    if (manifest >= 0)
+        close(manifest);
+    manifest = -1;
+
+    unlink(manifestPath.c_str());
+}
+
+/**
+ * @brief Prints how often the cache was used
+ *
+ */
+void ResultCache::report()
+{
+    cout << "Cache: " << hits << " hit(s), " << misses << " miss(es), " << resumed;
+    cout << " resumed from the manifest, " << waits << " wait(s) for an identical instance\n";
+}
+
+/**
+ * @brief Adds a finished task to the manifest. The cache's lock must be held.
+ *
+ * @param res   The result of the task
+ * @param key   The key of the result
+ */
+void ResultCache::record(Result* res, const uint64_t key)
+{
+    if (manifest < 0)
+        return;
+
+    char line[64];
+    int size = snprintf(line, sizeof(line), "%d %d %016llx\n", res->datafile, res->alg, (unsigned long long)key);
+    if (write(manifest, line, size) != size)
+        cout << "Could not write the cache manifest " << manifestPath << "\n";
+}
+
+/**
+ * @brief Returns the path of a cache entry
+ *
+ * @param key       The key of the result
+ * @return string   The path
+ */
+string ResultCache::entryPath(const uint64_t key)
+{
+    char name[32];
+    snprintf(name, sizeof(name), "/%016llx.txt", (unsigned long long)key);
+    return directory + name;
+}
+
+/**
+ * @brief Reads a cache entry
+ *
+ * @param key   The key of the result
+ * @param res   Receives the result
+ * @return true If the entry exists and could be read
+ */
+bool ResultCache::readEntry(const uint64_t key, Result* res)
+{
+    ifstream file(entryPath(key));
+    string line;
+
+    return file.is_open() && getline(file, line) && resultFromLine(line, res);
+}
@@ -0,0 +1,227 @@
+/**
+ * @file ResultWriter.cpp
+ * @author Matthew Harker
+ * @brief A single thread that formats and writes the results of every
+ *          task, so the workers never wait on the disk. Workers hand over
+ *          a Result record through a bounded queue and block once it is
+ *          full, which keeps memory bounded when the disk is slow.
+ * @version 1.0
+ * @date 2019-06-04
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+#include <chrono>
+#include <iostream>
+
+#include "flowshop.h"
+#include "Options.h"
+#include "ResultWriter.h"
+#include "Trace.h"
+
+using namespace std;
+
+/**
+ * @brief Construct a new ResultWriter:: ResultWriter object and start the
+ *          writer thread
+ *
+ * @param cap   How many records may be waiting before workers block
+ * @param table The summary table of the batch, or nullptr for none
+ * @param ring  Where results are published, or nullptr for nowhere
+ * @param source The bundle the instances are read again from at the full
+ *              output level, or nullptr to read the datafiles
+ */
+ResultWriter::ResultWriter(const size_t cap, Summary* table, Publisher* ring, Bundle* source)
+{
+    capacity = (cap > 0) ? cap : 1;
+    done     = false;
+    written  = 0;
+    waits    = 0;
+    waitTime = 0;
+    output   = parseOutputLevel(getOptions()->getString("output", "summary"));
+    gantt    = parseGanttFormat(getOptions()->getString("gantt", "csv"));
+    summary  = table;
+    publisher = ring;
+    bundle   = source;
+
+    writer = thread(&ResultWriter::drain, this);
+}
+
+/**
+ * @brief Destroy the ResultWriter:: ResultWriter object. Writes everything
+ *          still in the queue first.
+ *
+ */
+ResultWriter::~ResultWriter()
+{
+    finish();
+}
+
+/**
+ * @brief Returns how many records are waiting to be written
+ *
+ * @return size_t The depth of the queue
+ */
+size_t ResultWriter::queued()
+{
+    unique_lock<mutex> lock(queueMutex);
+    return records.size();
+}
+
+/**
+ * @brief Hands a finished record to the writer. Blocks while the queue is
+ *          full. The writer takes ownership of the record.
+ *
+ * @param res The record to write
+ */
+void ResultWriter::push(Result* res)
+{
+    unique_lock<mutex> lock(queueMutex);
+
+    // wait for room, timing how long the worker was held up
+    if (records.size() >= capacity)
+    {
+        TraceScope trace("writer-full", "writer");
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        notFull.wait(lock, [this] { return records.size() < capacity; });
+
+        ++waits;
+        waitTime += chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    }
+
+    records.push(res);
+    lock.unlock();
+    notEmpty.notify_one();
+}
+
+/**
+ * @brief Writes everything still in the queue and stops the writer thread
+ *
+ */
+void ResultWriter::finish()
+{
+    {
+        unique_lock<mutex> lock(queueMutex);
+        done = true;
+    }
+    notEmpty.notify_all();
+
+    if (writer.joinable())
+        writer.join();
+}
+
+/**
+ * @brief Prints how many records were written and how long workers waited
+ *
+ */
+void ResultWriter::report()
+{
+    cout << "Writer: " << written << " result(s) written, workers waited ";
+    cout << waits << " time(s) for " << waitTime << " ms\n";
+}
+
+/**
+ * @brief The loop of the writer thread. Takes records off the queue until
+ *          the batch is finished and the queue is empty.
+ *
+ */
+void ResultWriter::drain()
+{
+    Trace::nameThread("writer");
+
+    for (;;)
+    {
+        Result* res;
+
+        {
+            unique_lock<mutex> lock(queueMutex);
+            notEmpty.wait(lock, [this] { return done || !records.empty(); });
+            if (records.empty())
+                return;
+
+            res = records.front();
+            records.pop();
+        }
+        notFull.notify_one();
+
+        write(res);
+        ++written;
+    }
+}
+
+/**
+ * @brief At the full output level, reads the record's instance again,
+ *          rebuilds the completion times of its sequence, and writes its
+ *          files, timing them as the write phase. Records don't carry their
+ *          instance, so a full queue holds sequences rather than matrices.
+ *          Below full the completion times are never built, they can be
+ *          rebuilt later from the sequence (see schedule.out). Then adds the
+ *          record to the summary table and the totals, publishes it, and
+ *          frees it.
+ *
+ * @param res The record to write
+ */
+void ResultWriter::write(Result* res)
+{
+    TraceScope trace("write", "writer");
+    trace.setArg(0, "datafile", res->datafile);
+    trace.setArg(1, "alg", res->alg);
+
+    if (output == OUTPUT_FULL)
+    {
+        res->mem.startPhase();
+
+        // read the instance again, from the bundle if the batch has one
+        Matrix* jobs = (bundle != nullptr) ? bundle->getMatrix(res->datafile) : nullptr;
+        if (jobs == nullptr)
+            jobs = new Matrix(res->datafile);
+
+        // rebuild the permutation object of the best sequence
+        Permutation* perm = new Permutation(jobs->getCols());
+        for (size_t i = 0; i < res->sequence.size(); ++i)
+            perm->addElement(res->sequence[i]);
+        perm->setCurrentToBest();
+        perm->setBestVal(res->cmax);
+
+        // recreate the completion times of the sequence
+        Matrix* comp = new Matrix(jobs->getRows(), jobs->getCols());
+        fssTypePerm(jobs, comp, perm, res->alg);
+
+        res->mem.writeAllData(jobs, comp, perm, res->alg, res->datafile, gantt, &buffer);
+
+        delete comp;
+        delete perm;
+        delete jobs;
+
+        res->mem.endPhase(PHASE_WRITE);
+    }
+
+    if (summary != nullptr)
+        summary->add(res);
+    if (publisher != nullptr)
+        publisher->publish(res);
+    totals.addTotals(res->mem);
+
+    delete res;
+}
+
+/**
+ * @brief Returns how many records have been written
+ *
+ * @return long The number of records
+ */
+long ResultWriter::getWritten()
+{
+    return written;
+}
+
+/**
+ * @brief Returns the function calls and times summed over every record
+ *          written so far. Call after finish().
+ *
+ * @return Memory* The totals
+ */
+Memory* ResultWriter::getTotals()
+{
+    return &totals;
+}
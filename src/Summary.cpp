@@ -0,0 +1,200 @@
+/**
+ * @file Summary.cpp
+ * @author Matthew Harker
+ * @brief Writes the summary table of a batch: one CSV file with a row for
+ *          every (datafile, algorithm), holding the numbers that are
+ *          compared between runs. Rows are gathered in a buffer and
+ *          appended to the file in large writes.
+ * @version 1.0
+ * @date 2019-06-11
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+#include <cerrno>
+#include <fcntl.h>
+#include <iostream>
+#include <unistd.h>
+
+#include "Summary.h"
+
+using namespace std;
+
+// rows are appended once this many bytes are waiting
+static const size_t SUMMARY_FLUSH = 64 * 1024;
+
+/**
+ * @brief Construct a new Summary:: Summary object
+ *
+ */
+Summary::Summary()
+{
+    fd        = -1;
+    rows      = 0;
+    sequences = false;
+    counts    = false;
+    allocs    = false;
+}
+
+/**
+ * @brief Destroy the Summary:: Summary object. Appends any rows still waiting.
+ *
+ */
+Summary::~Summary()
+{
+    close();
+}
+
+/**
+ * @brief Starts a new table, replacing any file already at the path
+ *
+ * @param path          Where to write the table
+ * @param withSequences Whether each row ends with the job sequence, so the
+ *                          schedule can be rebuilt later
+ * @param withCounts    Whether each row has the hardware counts of its task
+ * @param withAllocs    Whether each row has the allocations of its task
+ * @return true         If the file could be created
+ */
+bool Summary::open(const string path, const bool withSequences, const bool withCounts, const bool withAllocs)
+{
+    close();
+
+    pathname = path;
+    fd = ::open(pathname.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0644);
+    if (fd < 0)
+    {
+        cout << "Summary " << pathname << " could not be created, no summary will be written\n";
+        return false;
+    }
+
+    rows      = 0;
+    sequences = withSequences;
+    counts    = withCounts;
+    allocs    = withAllocs;
+    buffer.clear();
+    buffer.putString("datafile,algorithm,jobs,cmax,original_cmax,function_calls,time_ms");
+    for (int p = 0; p < PHASE_COUNT; ++p)
+    {
+        buffer.putChar(',');
+        buffer.putString(PHASE_NAMES[p]);
+        buffer.putString("_ms");
+    }
+    for (int c = 0; c < COUNTER_COUNT && counts; ++c)
+    {
+        buffer.putChar(',');
+        buffer.putString(COUNTER_NAMES[c]);
+    }
+    for (int a = 0; a < ALLOC_STATS && allocs; ++a)
+    {
+        buffer.putChar(',');
+        buffer.putString(ALLOC_NAMES[a]);
+    }
+    buffer.putString(sequences ? ",sequence\n" : "\n");
+    return true;
+}
+
+/**
+ * @brief Adds the row of one result
+ *
+ * @param res The result
+ */
+void Summary::add(Result* res)
+{
+    static const char* names[] = { "", "FSS", "FSSB", "FSSNW" };
+
+    if (fd < 0)
+        return;
+
+    buffer.putInt(res->datafile);
+    buffer.putChar(',');
+    buffer.putString((res->alg >= 1 && res->alg <= 3) ? names[res->alg] : "");
+    buffer.putChar(',');
+    buffer.putInt(res->sequence.size());
+    buffer.putChar(',');
+    buffer.putInt(res->cmax);
+    buffer.putChar(',');
+    buffer.putInt(res->mem.getOriginalCmax());
+    buffer.putChar(',');
+    buffer.putInt(res->mem.getFuncCalls());
+    buffer.putChar(',');
+    buffer.putDouble(res->mem.getTimeTaken());
+    for (int p = 0; p < PHASE_COUNT; ++p)
+    {
+        buffer.putChar(',');
+        buffer.putDouble(res->mem.getPhaseTime(p));
+    }
+
+    // a count that was not measured is left empty
+    for (int c = 0; c < COUNTER_COUNT && counts; ++c)
+    {
+        buffer.putChar(',');
+        if (res->mem.getCount(c) >= 0)
+            buffer.putInt(res->mem.getCount(c));
+    }
+    for (int a = 0; a < ALLOC_STATS && allocs; ++a)
+    {
+        buffer.putChar(',');
+        if (res->mem.hasAllocations())
+            buffer.putInt(res->mem.getAllocation(a));
+    }
+
+    // the jobs are numbered from 1, like in the rawData files
+    if (sequences)
+    {
+        buffer.putChar(',');
+        for (size_t i = 0; i < res->sequence.size(); ++i)
+        {
+            if (i > 0) buffer.putChar(' ');
+            buffer.putInt(res->sequence[i] + 1);
+        }
+    }
+    buffer.putChar('\n');
+    ++rows;
+
+    if (buffer.size() >= SUMMARY_FLUSH)
+        flush();
+}
+
+/**
+ * @brief Appends the rows waiting in the buffer to the file
+ *
+ */
+void Summary::flush()
+{
+    size_t done = 0;
+    while (done < buffer.size())
+    {
+        ssize_t n = write(fd, buffer.data() + done, buffer.size() - done);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            break;
+
+        done += n;
+    }
+
+    buffer.clear();
+}
+
+/**
+ * @brief Appends the last rows and closes the file
+ *
+ */
+void Summary::close()
+{
+    if (fd < 0)
+        return;
+
+    flush();
+    ::close(fd);
+    fd = -1;
+}
+
+/**
+ * @brief Prints how many rows the table has and where it is
+ *
+ */
+void Summary::report()
+{
+    cout << "Summary: " << rows << " row(s) in " << pathname << "\n";
+}
@@ -0,0 +1,363 @@
+/**
+ * @file Topology.cpp
+ * @author Matthew Harker
+ * @brief Detects the socket/core/NUMA layout of the machine and pins the
+ *          thread pool workers to it. Pinned workers allocate their Matrix
+ *          objects themselves, so first-touch keeps each instance on the
+ *          NUMA node of the worker that uses it.
+ * @version 1.0
+ * @date 2019-06-03
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+#include <algorithm>
+#include <dirent.h>
+#include <fstream>
+#include <iostream>
+#include <pthread.h>
+#include <sched.h>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "Topology.h"
+
+using namespace std;
+
+/**
+ * @brief Parses a linux cpu list (such as "0-3,8,10-11") into cpu numbers
+ *
+ * @param list          The cpu list to parse
+ * @return vector<int>  The cpus in the list
+ */
+static vector<int> parseCpuList(const string list)
+{
+    vector<int> result;
+    stringstream ss(list);
+    string range;
+
+    while (getline(ss, range, ','))
+    {
+        if (range.empty())
+            continue;
+
+        // a range is either "n" or "n-m"
+        size_t dash = range.find('-');
+        int first = atoi(range.c_str());
+        int last  = (dash == string::npos) ? first : atoi(range.c_str() + dash + 1);
+
+        for (int c = first; c <= last; ++c)
+            result.push_back(c);
+    }
+
+    return result;
+}
+
+/**
+ * @brief Converts the name of an affinity mode into its AFFINITY_* value
+ *
+ * @param name  The name of the mode: none, node, core, or smt
+ * @return int  The AFFINITY_* value of the mode
+ */
+int parseAffinity(const string name)
+{
+    if (name == "node") return AFFINITY_NODE;
+    if (name == "core") return AFFINITY_CORE;
+    if (name == "smt")  return AFFINITY_SMT;
+
+    if (name != "none")
+        cout << "Unknown affinity \"" << name << "\", workers will not be pinned\n";
+
+    return AFFINITY_NONE;
+}
+
+/**
+ * @brief Construct a new Topology:: Topology object
+ *
+ */
+Topology::Topology()
+{
+    mode        = AFFINITY_NONE;
+    numPackages = 1;
+    numNodes    = 1;
+    numCores    = 1;
+}
+
+/**
+ * @brief Reads a single integer out of a sysfs file
+ *
+ * @param path      The file to read
+ * @param fallback  The value to use if the file does not exist
+ * @return int      The value in the file
+ */
+int Topology::readSysInt(const string path, const int fallback)
+{
+    int val = fallback;
+
+    ifstream file(path);
+    if (file.is_open())
+        file >> val;
+
+    return val;
+}
+
+/**
+ * @brief Finds every cpu this process is allowed to run on along with the
+ *          core, socket, and NUMA node it belongs to
+ *
+ */
+void Topology::detect()
+{
+    cpus.clear();
+
+    // only consider the cpus the process is allowed to use
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0)
+    {
+        int count = thread::hardware_concurrency();
+        for (int c = 0; c < count; ++c)
+            CPU_SET(c, &allowed);
+    }
+
+    // map each cpu to its NUMA node
+    vector<int> nodeOf(CPU_SETSIZE, 0);
+    set<int> nodes;
+    DIR* dir = opendir("/sys/devices/system/node");
+    if (dir != nullptr)
+    {
+        struct dirent* entry;
+        while ((entry = readdir(dir)) != nullptr)
+        {
+            string name = entry->d_name;
+            if (name.compare(0, 4, "node") != 0 || name.size() < 5 || !isdigit(name[4]))
+                continue;
+
+            int node = atoi(name.c_str() + 4);
+
+            string list;
+            ifstream file("/sys/devices/system/node/" + name + "/cpulist");
+            if (file.is_open())
+                getline(file, list);
+
+            vector<int> nodeCpus = parseCpuList(list);
+            for (size_t i = 0; i < nodeCpus.size(); ++i)
+                if (nodeCpus[i] >= 0 && nodeCpus[i] < CPU_SETSIZE)
+                    nodeOf[nodeCpus[i]] = node;
+        }
+        closedir(dir);
+    }
+
+    // record the layout of every allowed cpu
+    set< pair<int, int> > cores;
+    set<int> packages;
+    for (int c = 0; c < CPU_SETSIZE; ++c)
+    {
+        if (!CPU_ISSET(c, &allowed))
+            continue;
+
+        string base = "/sys/devices/system/cpu/cpu" + to_string(c) + "/topology/";
+
+        CpuInfo info;
+        info.cpu     = c;
+        info.core    = readSysInt(base + "core_id", c);
+        info.package = readSysInt(base + "physical_package_id", 0);
+        info.node    = nodeOf[c];
+        cpus.push_back(info);
+
+        cores.insert(make_pair(info.package, info.core));
+        packages.insert(info.package);
+        nodes.insert(info.node);
+    }
+
+    numCores    = max(1, (int)cores.size());
+    numPackages = max(1, (int)packages.size());
+    numNodes    = max(1, (int)nodes.size());
+}
+
+/**
+ * @brief Returns how many logical cpus are available
+ *
+ * @return int The number of logical cpus
+ */
+int Topology::getNumCpus()
+{
+    return cpus.size();
+}
+
+/**
+ * @brief Returns how many physical cores are available
+ *
+ * @return int The number of physical cores
+ */
+int Topology::getNumCores()
+{
+    return numCores;
+}
+
+/**
+ * @brief Returns how many NUMA nodes are available
+ *
+ * @return int The number of NUMA nodes
+ */
+int Topology::getNumNodes()
+{
+    return numNodes;
+}
+
+/**
+ * @brief Decides which cpus each worker will run on
+ *
+ * @param affinity  The AFFINITY_* mode to place the workers with
+ * @param threads   How many workers to use when the mode does not decide it
+ */
+void Topology::plan(const int affinity, const int threads)
+{
+    mode = affinity;
+    placement.clear();
+
+    // without a detected layout there is nothing to pin to
+    if (cpus.empty())
+        mode = AFFINITY_NONE;
+
+    if (mode == AFFINITY_NONE)
+    {
+        placement.resize(max(1, threads));
+    }
+    else if (mode == AFFINITY_NODE)
+    {
+        // collect the cpus of each node
+        vector<int> nodeIds;
+        for (size_t i = 0; i < cpus.size(); ++i)
+            if (find(nodeIds.begin(), nodeIds.end(), cpus[i].node) == nodeIds.end())
+                nodeIds.push_back(cpus[i].node);
+        sort(nodeIds.begin(), nodeIds.end());
+
+        // hand the nodes out round robin
+        placement.resize(max(1, threads));
+        for (size_t w = 0; w < placement.size(); ++w)
+        {
+            int node = nodeIds[w % nodeIds.size()];
+            for (size_t i = 0; i < cpus.size(); ++i)
+                if (cpus[i].node == node)
+                    placement[w].push_back(cpus[i].cpu);
+        }
+    }
+    else
+    {
+        // order the cpus so SMT siblings sit next to each other
+        vector<CpuInfo> order = cpus;
+        sort(order.begin(), order.end(), [](const CpuInfo& a, const CpuInfo& b)
+        {
+            if (a.package != b.package) return a.package < b.package;
+            if (a.core    != b.core)    return a.core    < b.core;
+            return a.cpu < b.cpu;
+        });
+
+        if (mode == AFFINITY_CORE)
+        {
+            // keep the first hardware thread of every core, spreading the
+            // workers over the sockets so both memory controllers are used
+            vector< vector<int> > perPackage;
+            vector<int> packageIds;
+            for (size_t i = 0; i < order.size(); ++i)
+            {
+                if (i > 0 && order[i].package == order[i-1].package && order[i].core == order[i-1].core)
+                    continue;
+
+                size_t p = find(packageIds.begin(), packageIds.end(), order[i].package) - packageIds.begin();
+                if (p == packageIds.size())
+                {
+                    packageIds.push_back(order[i].package);
+                    perPackage.push_back(vector<int>());
+                }
+                perPackage[p].push_back(order[i].cpu);
+            }
+
+            for (size_t k = 0; ; ++k)
+            {
+                bool added = false;
+                for (size_t p = 0; p < perPackage.size(); ++p)
+                {
+                    if (k < perPackage[p].size())
+                    {
+                        placement.push_back(vector<int>(1, perPackage[p][k]));
+                        added = true;
+                    }
+                }
+                if (!added) break;
+            }
+        }
+        else
+        {
+            // one worker for every hardware thread
+            for (size_t i = 0; i < order.size(); ++i)
+                placement.push_back(vector<int>(1, order[i].cpu));
+        }
+    }
+}
+
+/**
+ * @brief Returns how many workers the plan calls for
+ *
+ * @return size_t The number of workers
+ */
+size_t Topology::getNumWorkers()
+{
+    return placement.size();
+}
+
+/**
+ * @brief Pins the calling thread to the cpus planned for a worker. Must be
+ *          called from the worker thread itself.
+ *
+ * @param worker The index of the worker
+ */
+void Topology::pinWorker(const size_t worker)
+{
+    if (worker >= placement.size() || placement[worker].empty())
+        return;
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (size_t i = 0; i < placement[worker].size(); ++i)
+        CPU_SET(placement[worker][i], &set);
+
+    if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0)
+        cout << "Could not pin worker " << worker << ", it will float\n";
+}
+
+/**
+ * @brief Prints the detected layout and where each worker was placed
+ *
+ */
+void Topology::report()
+{
+    const char* names[] = { "none", "node", "core", "smt" };
+
+    cout << "Topology: " << numPackages << " socket(s), " << numNodes << " NUMA node(s), ";
+    cout << numCores << " core(s), " << cpus.size() << " hardware thread(s)\n";
+    cout << "Affinity: " << names[mode] << ", " << placement.size() << " worker(s)\n";
+
+    if (mode == AFFINITY_NONE)
+        return;
+
+    // print the cpus and node of each worker
+    for (size_t w = 0; w < placement.size(); ++w)
+    {
+        int node = -1;
+        cout << "  worker " << w << " -> cpu";
+        for (size_t i = 0; i < placement[w].size(); ++i)
+        {
+            cout << (i == 0 ? " " : ",") << placement[w][i];
+            for (size_t k = 0; k < cpus.size(); ++k)
+                if (cpus[k].cpu == placement[w][i])
+                    node = cpus[k].node;
+        }
+        cout << " (node " << node << ")\n";
+    }
+}
@@ -0,0 +1,209 @@
+/**
+ * @file Trace.cpp
+ * @author Matthew Harker
+ * @brief A timeline of the batch in the Chrome trace event format. Every
+ *          thread records its spans into a buffer of its own, and the
+ *          buffers are written as one JSON file when the batch is over.
+ * @version 1.0
+ * @date 2019-06-19
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+#include <iostream>
+#include <mutex>
+
+#include "OutputBuffer.h"
+#include "Trace.h"
+
+using namespace std;
+
+atomic<bool> Trace::enabled(false);
+chrono::steady_clock::time_point Trace::epoch;
+
+// every thread's buffer, the lock is only taken the first time a thread
+// records something
+static mutex registryMutex;
+static vector<TraceBuffer*> buffers;
+
+/**
+ * @brief Returns the buffer of the calling thread, making it the first time.
+ *          Buffers outlive their threads so they can be written at the end.
+ *
+ * @return TraceBuffer* The thread's buffer
+ */
+static TraceBuffer* forThread()
+{
+    static thread_local TraceBuffer* mine = nullptr;
+    if (mine != nullptr)
+        return mine;
+
+    unique_lock<mutex> lock(registryMutex);
+    mine = new TraceBuffer();
+    mine->tid  = buffers.size() + 1;
+    mine->name = "thread " + to_string(mine->tid);
+    mine->events.reserve(1024);
+    buffers.push_back(mine);
+    return mine;
+}
+
+/**
+ * @brief Starts recording, dropping the events of any earlier trace
+ *
+ * @return true If the trace started
+ */
+bool Trace::start()
+{
+    if (isEnabled())
+        return false;
+
+    {
+        unique_lock<mutex> lock(registryMutex);
+        for (size_t b = 0; b < buffers.size(); ++b)
+            buffers[b]->events.clear();
+    }
+
+    epoch = chrono::steady_clock::now();
+    enabled = true;
+    return true;
+}
+
+/**
+ * @brief Stops every thread recording, without writing anything. Used by
+ *          forked worker processes.
+ *
+ */
+void Trace::stopRecording()
+{
+    enabled = false;
+}
+
+/**
+ * @brief Returns the time since the trace started
+ *
+ * @return uint64_t The time (ns)
+ */
+uint64_t Trace::now()
+{
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - epoch).count();
+}
+
+/**
+ * @brief Names the calling thread's row of the timeline
+ *
+ * @param name The name, such as "pool 2"
+ */
+void Trace::nameThread(const string name)
+{
+    if (isEnabled())
+        forThread()->name = name;
+}
+
+/**
+ * @brief Adds a finished span to the calling thread's buffer
+ *
+ * @param event The span
+ */
+void Trace::record(const TraceEvent& event)
+{
+    forThread()->events.push_back(event);
+}
+
+/**
+ * @brief Adds a time in microseconds (the unit of the format) with
+ *          nanosecond digits
+ *
+ * @param buffer    The JSON being built
+ * @param nanos     The time (ns)
+ */
+static void putMicros(OutputBuffer* buffer, const uint64_t nanos)
+{
+    buffer->putInt(nanos / 1000);
+    buffer->putChar('.');
+
+    int frac = nanos % 1000;
+    buffer->putChar('0' + frac / 100);
+    buffer->putChar('0' + frac / 10 % 10);
+    buffer->putChar('0' + frac % 10);
+}
+
+/**
+ * @brief Stops recording and writes every thread's events. Every thread
+ *          that recorded must be idle by now.
+ *
+ * @param path The JSON file to write
+ */
+void Trace::finish(const string path)
+{
+    if (!isEnabled())
+        return;
+    enabled = false;
+
+    unique_lock<mutex> lock(registryMutex);
+
+    OutputBuffer buffer;
+    buffer.putString("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+    size_t count = 0, threads = 0;
+    bool first = true;
+    for (size_t b = 0; b < buffers.size(); ++b)
+    {
+        TraceBuffer* owner = buffers[b];
+        if (owner->events.empty())
+            continue;
+        ++threads;
+
+        // the row of each thread is named by a metadata event
+        if (!first) buffer.putString(",\n");
+        first = false;
+        buffer.putString("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":");
+        buffer.putInt(owner->tid);
+        buffer.putString(",\"args\":{\"name\":\"");
+        buffer.putString(owner->name.c_str());
+        buffer.putString("\"}}");
+
+        for (size_t e = 0; e < owner->events.size(); ++e)
+        {
+            const TraceEvent& event = owner->events[e];
+
+            buffer.putString(",\n{\"name\":\"");
+            buffer.putString(event.name);
+            buffer.putString("\",\"cat\":\"");
+            buffer.putString(event.category);
+            buffer.putString("\",\"ph\":\"X\",\"pid\":1,\"tid\":");
+            buffer.putInt(owner->tid);
+            buffer.putString(",\"ts\":");
+            putMicros(&buffer, event.start);
+            buffer.putString(",\"dur\":");
+            putMicros(&buffer, event.duration);
+
+            if (event.keys[0] != nullptr)
+            {
+                buffer.putString(",\"args\":{");
+                for (int a = 0; a < TRACE_ARGS && event.keys[a] != nullptr; ++a)
+                {
+                    if (a > 0) buffer.putChar(',');
+                    buffer.putChar('"');
+                    buffer.putString(event.keys[a]);
+                    buffer.putString("\":");
+                    buffer.putInt(event.values[a]);
+                }
+                buffer.putChar('}');
+            }
+            buffer.putChar('}');
+        }
+
+        count += owner->events.size();
+        vector<TraceEvent>().swap(owner->events);
+    }
+
+    buffer.putString("\n]}\n");
+
+    if (!buffer.writeFile(path.c_str()))
+    {
+        cout << "Could not write the trace file " << path << "\n";
+        return;
+    }
+
+    cout << "Trace: " << count << " event(s) from " << threads << " thread(s) in " << path << "\n";
+}
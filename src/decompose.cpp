@@ -0,0 +1,492 @@
+/**
+ * @file decompose.cpp
+ * @author Matthew Harker
+ * @brief Splits the jobs of a very large instance into blocks, builds a
+ *          sequence for every block with NEH (in parallel on the thread
+ *          pool), and stitches the blocks back together. The jobs around
+ *          each seam are then repaired by reinserting them one at a time.
+ * @version 1.0
+ * @date 2019-06-06
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "Counters.h"
+#include "decompose.h"
+#include "flowshop.h"
+#include "fss.h"
+#include "fssb.h"
+#include "fssnw.h"
+#include "Trace.h"
+
+using namespace std;
+
+/**
+ * @brief Converts the name of a split rule into its SPLIT_* value
+ *
+ * @param name  The name of the rule: index, cost, or stride
+ * @return int  The SPLIT_* value of the rule
+ */
+int parseSplitRule(const string name)
+{
+    if (name == "index")  return SPLIT_INDEX;
+    if (name == "stride") return SPLIT_STRIDE;
+
+    if (name != "cost")
+        cout << "Unknown split rule \"" << name << "\", splitting by cost\n";
+
+    return SPLIT_COST;
+}
+
+/**
+ * @brief Optimizes an instance by solving blocks of its jobs separately
+ *
+ * @param jobs      The matrix of job run times
+ * @param mem       Records the number of evaluations and the time of each phase
+ * @param alg       The FSS algorithm to use
+ * @param tp        The thread pool the blocks are shared with
+ * @param blockSize How many jobs go in each block
+ * @param rule      The SPLIT_* rule used to form the blocks
+ * @param radius    How many jobs on each side of a seam are repaired
+ * @param sequence  Receives the final job sequence
+ * @return int      The makespan of the final sequence
+ */
+int decompose(Matrix* jobs, Memory* mem, const int alg, ThreadPool* tp, const int blockSize,
+              const int rule, const int radius, vector<int>& sequence)
+{
+    // the work shared with the helpers, kept alive by whoever finishes last
+    struct Work {
+        vector< vector<int> > blocks;
+        vector< vector<int> > results;
+        vector<int> calls;
+
+        // the hardware counts of the blocks other threads solved
+        bool counting;
+        thread::id owner;
+        long long counts[COUNTER_COUNT];
+
+        atomic<size_t> next;
+        size_t finished;
+        mutex doneMutex;
+        condition_variable done;
+    };
+
+    mem->startPhase();
+
+    shared_ptr<Work> work = make_shared<Work>();
+    work->blocks = splitJobs(jobs, blockSize, rule);
+    mem->endPhase(PHASE_SORT);
+
+    work->results.resize(work->blocks.size());
+    work->calls.resize(work->blocks.size(), 0);
+    work->next     = 0;
+    work->finished = 0;
+
+    // the task's own counters only count this thread, so the blocks helpers
+    // solve are counted on their own and added to the task's
+    work->counting = Counters::forThread()->isRunning();
+    work->owner    = this_thread::get_id();
+    for (int c = 0; c < COUNTER_COUNT; ++c)
+        work->counts[c] = -1;
+
+    // takes blocks until there are none left
+    function<void()> solve = [work, jobs, alg]()
+    {
+        for (;;)
+        {
+            size_t b = work->next++;
+            if (b >= work->blocks.size())
+                return;
+
+            TraceScope block("block", "decompose");
+            block.setArg(0, "block", b);
+            block.setArg(1, "jobs", work->blocks[b].size());
+
+            Counters* helper = (work->counting && this_thread::get_id() != work->owner) ?
+                Counters::forHelper() : nullptr;
+            if (helper != nullptr)
+                helper->start();
+
+            Memory blockMem;
+            solveBlock(jobs, work->blocks[b], &blockMem, alg, work->results[b]);
+            work->calls[b] = blockMem.getFuncCalls();
+
+            long long counts[COUNTER_COUNT];
+            if (helper != nullptr)
+                helper->stop(counts);
+
+            {
+                unique_lock<mutex> lock(work->doneMutex);
+                ++work->finished;
+                for (int c = 0; helper != nullptr && c < COUNTER_COUNT; ++c)
+                    if (counts[c] >= 0)
+                        work->counts[c] = max(work->counts[c], 0LL) + counts[c];
+            }
+            work->done.notify_all();
+        }
+    };
+
+    // other workers help when they are free; this thread works too, so the
+    // blocks finish even if every worker is busy with its own instance
+    size_t helpers = min(work->blocks.size() - 1, (size_t)thread::hardware_concurrency());
+    for (size_t h = 0; h < helpers; ++h)
+        tp->enqueue(solve);
+    solve();
+
+    {
+        unique_lock<mutex> lock(work->doneMutex);
+        work->done.wait(lock, [work] { return work->finished == work->blocks.size(); });
+    }
+    mem->addCounts(work->counts);
+
+    // stitch the blocks together, remembering where the seams are
+    sequence.clear();
+    vector<int> seams;
+    for (size_t b = 0; b < work->results.size(); ++b)
+    {
+        if (b > 0) seams.push_back(sequence.size());
+        sequence.insert(sequence.end(), work->results[b].begin(), work->results[b].end());
+        mem->addFuncCalls(work->calls[b]);
+    }
+
+    // evaluate the stitched sequence
+    int n = sequence.size();
+    Permutation* perm = new Permutation(n);
+    Matrix* comp = new Matrix(jobs->getRows(), n);
+
+    for (int c = 0; c < n; ++c)
+        perm->addElement(sequence[c]);
+    int best = fssTypePerm(jobs, comp, perm, alg);
+    mem->incrFuncCalls();
+    mem->endPhase(PHASE_NEH);
+
+    // repair each seam, keeping the change only if the whole sequence improves.
+    // comp always holds the accepted sequence, so a changed seam is only
+    // evaluated from its first column, and only until the columns after it
+    // just move by a constant
+    vector<int> saved;
+    TraceScope repair("repair", "decompose");
+    repair.setArg(0, "seams", seams.size());
+    for (size_t s = 0; s < seams.size() && radius > 0; ++s)
+    {
+        int lo = max(0, seams[s] - radius);
+        int hi = min(n, seams[s] + radius);
+        vector<int> before(sequence.begin() + lo, sequence.begin() + hi);
+
+        repairBoundary(jobs, alg, lo, hi, mem, sequence);
+        if (equal(before.begin(), before.end(), sequence.begin() + lo))
+            continue;
+
+        for (int c = lo; c < hi; ++c)
+            perm->getPerm()[c] = sequence[c];
+        int shift;
+        int last = evaluateFrom(jobs, comp, perm, alg, lo, hi, saved, shift);
+        int val = (last < n) ? best + shift : comp->getVal(comp->getRows()-1, n-1);
+        mem->incrFuncCalls();
+
+        if (val <= best)
+        {
+            best = val;
+            shiftColumns(comp, last, n, shift);
+        }
+        else
+        {
+            // put the seam and its columns back the way they were
+            copy(before.begin(), before.end(), sequence.begin() + lo);
+            copy(before.begin(), before.end(), perm->getPerm() + lo);
+            restoreColumns(comp, lo, last, saved);
+        }
+    }
+
+    mem->endPhase(PHASE_REPAIR);
+
+    delete comp;
+    delete perm;
+
+    return best;
+}
+
+/**
+ * @brief Evaluates a sequence again from one column on, reusing the
+ *          completion times before it. Every column only depends on the one
+ *          before it, and the recurrences only add and take maxima, so once
+ *          a column past the changed ones comes out as the old column moved
+ *          by the same amount on every machine, every later column moves by
+ *          that amount too and is not computed.
+ *
+ * @param jobs      The matrix of job run times
+ * @param comp      The completion times of the sequence before the change
+ * @param perm      The sequence, changed only in columns lo to hi-1
+ * @param alg       The FSS algorithm to use
+ * @param lo        The first changed column
+ * @param hi        One past the last changed column
+ * @param saved     Receives the old values of the columns written over,
+ *                      column after column
+ * @param shift     Receives how much the columns from the returned one on
+ *                      moved (0 if every column was computed)
+ * @return int      One past the last column written over
+ */
+int evaluateFrom(Matrix* jobs, Matrix* comp, Permutation* perm, const int alg, const int lo,
+                 const int hi, vector<int>& saved, int& shift)
+{
+    int rows = comp->getRows();
+    int n = perm->getCurSize();
+    saved.clear();
+    shift = 0;
+
+    for (int c = lo; c < n; ++c)
+    {
+        // no-wait raises the rows above as it goes, so save the column first
+        size_t start = saved.size();
+        for (int r = 0; r < rows; ++r)
+            saved.push_back(comp->getVal(r, c));
+
+        for (int r = 0; r < rows; ++r)
+        {
+            int time = 0;
+            switch (alg)
+            {
+                case 1: time = baseTimeFSSPerm(jobs, comp, perm, r, c);  break;
+                case 2: time = newTimeFSSBPerm(jobs, comp, perm, r, c);  break;
+                case 3: time = newTimeFSSNWPerm(jobs, comp, perm, r, c); break;
+            }
+            comp->setVal(time, r, c);
+        }
+
+        if (c < hi)
+            continue;
+
+        int moved = comp->getVal(0, c) - saved[start];
+        bool uniform = true;
+        for (int r = 1; r < rows && uniform; ++r)
+            uniform = comp->getVal(r, c) - saved[start + r] == moved;
+
+        if (uniform)
+        {
+            shift = moved;
+            return c + 1;
+        }
+    }
+
+    return n;
+}
+
+/**
+ * @brief Moves the completion times of a range of columns
+ *
+ * @param comp  The matrix of job completion times
+ * @param first The first column to move
+ * @param last  One past the last column to move
+ * @param shift How much to add to every completion time
+ */
+void shiftColumns(Matrix* comp, const int first, const int last, const int shift)
+{
+    if (shift == 0)
+        return;
+
+    for (int r = 0; r < comp->getRows(); ++r)
+    {
+        int* row = comp->getRow(r);
+        for (int c = first; c < last; ++c)
+            row[c] += shift;
+    }
+}
+
+/**
+ * @brief Puts back the columns evaluateFrom() wrote over
+ *
+ * @param comp  The matrix of job completion times
+ * @param lo    The first column written over
+ * @param last  One past the last column written over
+ * @param saved The old values, column after column
+ */
+void restoreColumns(Matrix* comp, const int lo, const int last, const vector<int>& saved)
+{
+    int rows = comp->getRows();
+    for (int c = lo; c < last; ++c)
+        for (int r = 0; r < rows; ++r)
+            comp->setVal(saved[(c - lo) * rows + r], r, c);
+}
+
+/**
+ * @brief Splits the jobs of an instance into blocks
+ *
+ * @param jobs      The matrix of job run times
+ * @param blockSize How many jobs go in each block
+ * @param rule      The SPLIT_* rule used to form the blocks
+ * @return vector< vector<int> > The job indices of each block
+ */
+vector< vector<int> > splitJobs(Matrix* jobs, const int blockSize, const int rule)
+{
+    int n = jobs->getCols();
+    int numBlocks = (n + blockSize - 1) / blockSize;
+
+    // order the jobs, by index or from the most to the least total work
+    vector<int> order(n);
+    for (int c = 0; c < n; ++c)
+        order[c] = c;
+
+    if (rule != SPLIT_INDEX)
+    {
+        jobs->generateJobCosts();
+        int* costs = jobs->getJobCosts();
+        stable_sort(order.begin(), order.end(), [costs](int a, int b) { return costs[a] > costs[b]; });
+    }
+
+    vector< vector<int> > blocks(numBlocks);
+    for (int i = 0; i < n; ++i)
+    {
+        if (rule == SPLIT_STRIDE)
+            blocks[i % numBlocks].push_back(order[i]);
+        else
+            blocks[i / blockSize].push_back(order[i]);
+    }
+
+    return blocks;
+}
+
+/**
+ * @brief Builds a sequence for one block of jobs using NEH
+ *
+ * @param jobs      The matrix of job run times of the whole instance
+ * @param block     The job indices in the block
+ * @param mem       Records the number of evaluations
+ * @param alg       The FSS algorithm to use
+ * @param sequence  Receives the block's sequence (as indices of jobs)
+ * @return int      The makespan of the block on its own
+ */
+int solveBlock(Matrix* jobs, const vector<int>& block, Memory* mem, const int alg, vector<int>& sequence)
+{
+    int rows = jobs->getRows();
+    int size = block.size();
+
+    // copy the block's columns into a matrix of its own
+    Matrix* sub = new Matrix(rows, size);
+    for (int r = 0; r < rows; ++r)
+        for (int c = 0; c < size; ++c)
+            sub->setVal(jobs->getVal(r, block[c]), r, c);
+
+    Matrix* comp = new Matrix(rows, size);
+    Permutation* perm = new Permutation(size);
+    initialize(sub, perm);
+
+    int cmax = neh(sub, comp, perm, mem, alg);
+
+    // translate the sequence back to the jobs of the instance
+    sequence.resize(size);
+    for (int c = 0; c < size; ++c)
+        sequence[c] = block[perm->getBest(c)];
+
+    delete sub;
+    delete comp;
+    delete perm;
+
+    return cmax;
+}
+
+/**
+ * @brief Repairs the jobs around a seam. Each job in the window is taken out
+ *          and put back where the window on its own has the lowest makespan.
+ *
+ * @param jobs      The matrix of job run times
+ * @param alg       The FSS algorithm to use
+ * @param lo        The first position of the window
+ * @param hi        One past the last position of the window
+ * @param mem       Records the number of evaluations
+ * @param sequence  The full sequence, the window is changed in place
+ * @return int      The makespan of the window on its own
+ */
+int repairBoundary(Matrix* jobs, const int alg, const int lo, const int hi, Memory* mem, vector<int>& sequence)
+{
+    int size = hi - lo;
+    if (size < 2)
+        return 0;
+
+    Matrix* comp = new Matrix(jobs->getRows(), size);
+    Permutation* perm = new Permutation(size);
+
+    vector<int> window(sequence.begin() + lo, sequence.begin() + hi);
+    vector<int> moving = window;
+
+    // evaluates the window as a sequence of its own
+    auto evaluate = [&](const vector<int>& seq)
+    {
+        perm->setCurSize(0);
+        for (int c = 0; c < size; ++c)
+            perm->addElement(seq[c]);
+        mem->incrFuncCalls();
+        return fssTypePerm(jobs, comp, perm, alg);
+    };
+
+    int best = evaluate(window);
+
+    for (int k = 0; k < size; ++k)
+    {
+        // take the job out
+        int from = find(window.begin(), window.end(), moving[k]) - window.begin();
+        vector<int> rest = window;
+        rest.erase(rest.begin() + from);
+
+        // and try it in every other position
+        for (int to = 0; to < size; ++to)
+        {
+            if (to == from)
+                continue;
+
+            vector<int> trial = rest;
+            trial.insert(trial.begin() + to, moving[k]);
+
+            int val = evaluate(trial);
+            if (val < best)
+            {
+                best   = val;
+                window = trial;
+                from   = to;
+                rest   = window;
+                rest.erase(rest.begin() + from);
+            }
+        }
+    }
+
+    copy(window.begin(), window.end(), sequence.begin() + lo);
+
+    mem->endPhase(PHASE_REPAIR);
+
+    delete comp;
+    delete perm;
+
+    return best;
+}
+
+/**
+ * @brief Evaluates part of a sequence on its own
+ *
+ * @param jobs      The matrix of job run times
+ * @param alg       The FSS algorithm to use
+ * @param sequence  The job sequence
+ * @param first     The first position to evaluate
+ * @param last      One past the last position to evaluate
+ * @return int      The makespan of the part
+ */
+int evalSequence(Matrix* jobs, const int alg, const vector<int>& sequence, const int first, const int last)
+{
+    Matrix* comp = new Matrix(jobs->getRows(), last - first);
+    Permutation* perm = new Permutation(last - first);
+
+    for (int c = first; c < last; ++c)
+        perm->addElement(sequence[c]);
+    int cmax = fssTypePerm(jobs, comp, perm, alg);
+
+    delete comp;
+    delete perm;
+
+    return cmax;
+}
@@ -12,6 +12,7 @@
  * 
  */
 
+#include <chrono>
 #include <climits>
 #include <fstream>
 #include <iostream>
@@ -19,13 +20,29 @@
 #include <random>
 #include <thread>
 #include <vector>
+#include <sys/resource.h>
 
+#include "Allocations.h"
+#include "Batch.h"
+#include "Bundle.h"
+#include "Coordinator.h"
+#include "Counters.h"
 #include "customPermutation.h"
+#include "decompose.h"
 #include "flowshop.h"
 #include "fss.h"
 #include "fssb.h"
 #include "fssnw.h"
+#include "Metrics.h"
+#include "Options.h"
+#include "Publisher.h"
+#include "Result.h"
+#include "ResultCache.h"
+#include "ResultWriter.h"
+#include "Summary.h"
 #include "ThreadPool.h"
+#include "Topology.h"
+#include "Trace.h"
 
 using namespace std;
 
@@ -37,6 +54,9 @@ void run()
 {
     int custPerm;
 
+    // read in the optional settings, every one of them has a default
+    getOptions()->load("parameters/options.txt");
+
     // read in wether to use a customer permutation or run all
     string path = "parameters/custPerm.txt";
     ifstream file(path);
@@ -47,31 +67,137 @@ void run()
         if (custPerm == 1)
             customPermutation();
         else
-            runFlowshop();
+            runBatch();
     }
     else
     {
         cout << "Custom permutation file not found, continuing with NEH algorithm\n";
-        runFlowshop();
+        runBatch();
     }
 
     file.close();
 }
 
+/**
+ * @brief Runs the batch either in this process or spread over worker
+ *          processes, depending on the "processes" option
+ * 
+ */
+void runBatch()
+{
+    int processes = getOptions()->getInt("processes", 0);
+
+    if (processes > 0)
+        runCoordinator(processes);
+    else
+        runFlowshop();
+}
+
 /**
  * @brief Runs the specified datasets through the specified algorithms.
  * 
  */
 void runFlowshop()
 {
-    // set up threadpool
-    int numThreads =  thread::hardware_concurrency();
-    ThreadPool tp(numThreads);
+    // the batch is timed by the wall clock and by the CPU time it uses
+    chrono::steady_clock::time_point batchStart = chrono::steady_clock::now();
+    double cpuStart = cpuTime();
+
+    // the timeline of every thread, written when the batch is over
+    string tracePath = getOptions()->getString("trace", "none");
+    bool tracing = tracePath != "none" && Trace::start();
+    Trace::nameThread("main");
+
+    // decide where the workers will run and report it
+    Topology topo;
+    topo.detect();
+    int affinity = parseAffinity(getOptions()->getString("affinity", "none"));
+    topo.plan(affinity, thread::hardware_concurrency());
+    topo.report();
+
+    // set up threadpool, each worker pins itself before taking any tasks so
+    // the matrices it allocates are first touched on its own NUMA node
+    ThreadPool tp(topo.getNumWorkers(), [&topo](size_t w)
+    {
+        topo.pinWorker(w);
+        Trace::nameThread("pool " + to_string(w));
+    });
     vector<future<int>> futures;
 
+    // the bundle is mapped once for the whole batch, and must outlive the
+    // writer since the writer reads the instances from it again
+    Bundle bundle;
+    bool useBundle = openBundle(&bundle);
+
+    // results are formatted and written by their own thread
+    int writeQueue = getOptions()->getInt("writequeue", 0);
+    if (writeQueue <= 0) writeQueue = 2 * topo.getNumWorkers();
+    Summary summary;
+    string summaryPath = getOptions()->getString("summary", "results/summary.csv");
+    int output = parseOutputLevel(getOptions()->getString("output", "summary"));
+    bool counting = getOptions()->getString("counters", "off") == "on";
+    bool accounting = getOptions()->getString("allocations", "off") == "on";
+    bool useSummary = summaryPath != "none" && summary.open(summaryPath, output >= OUTPUT_SCHEDULE, counting, accounting);
+    Publisher publisher;
+    bool usePublisher = openPublisher(&publisher);
+    ResultWriter writer(writeQueue, useSummary ? &summary : nullptr, usePublisher ? &publisher : nullptr,
+                        useBundle ? &bundle : nullptr);
+
+    Batch batch;
+    batch.pool   = &tp;
+    batch.writer = &writer;
+    batch.bundle = useBundle ? &bundle : nullptr;
+    batch.counting = counting;
+    batch.accounting = accounting;
+
+    // results solved before are read back from the cache
+    ResultCache* cache = openCache(true);
+    batch.cache = cache;
+
     // create and initialize variables for the files to run
     int start, end, algStart, algEnd;
     initParameters(start, end, algStart, algEnd);
+    vector<int> datafiles = selectDatafiles(start, end, batch.bundle);
+
+    // live throughput and latency, reported every few seconds
+    Metrics metrics;
+    metrics.addGauge("pool", [&tp] { return tp.queued(); });
+    metrics.addGauge("writer", [&writer] { return writer.queued(); });
+    metrics.start(getOptions()->getString("metrics", "none"), getOptions()->getInt("metricsinterval", 5));
+
+    // the tasks of each algorithm. Tasks an interrupted batch finished go
+    // straight to the writer, unless their files must be written in full.
+    vector< vector<int> > tasks(algEnd + 1);
+    for (int i = algStart; i <= algEnd; ++i)
+    {
+        for (size_t j = 0; j < datafiles.size(); ++j)
+        {
+            Result* res = new Result();
+            if (cache != nullptr && output != OUTPUT_FULL && cache->resume(datafiles[j], i, res))
+            {
+                writer.push(res);
+                continue;
+            }
+
+            delete res;
+            tasks[i].push_back(datafiles[j]);
+        }
+    }
+
+    // read the instances ahead of the workers, in the order the tasks are
+    // queued, holding at most "prefetch" MB that no worker has taken yet.
+    // Pinned workers copy their instance so it sits on their own NUMA node.
+    int prefetch = getOptions()->getInt("prefetch", 64);
+    InstanceLoader* loader = nullptr;
+    if (prefetch > 0)
+    {
+        vector<int> order;
+        for (int i = algStart; i <= algEnd; ++i)
+            order.insert(order.end(), tasks[i].begin(), tasks[i].end());
+
+        loader = new InstanceLoader(order, batch.bundle, (size_t)prefetch << 20, affinity != AFFINITY_NONE);
+    }
+    batch.loader = loader;
 
     // for each algorithm
     for (int i = algStart; i <= algEnd; ++i)
@@ -80,18 +206,24 @@ void runFlowshop()
         else if (i == 2) cout << "Starting FSSB...\n";
         else if (i == 3) cout << "Starting FSSNW...\n";
 
+        TraceScope algorithm(i == 1 ? "FSS" : (i == 2 ? "FSSB" : "FSSNW"), "batch");
+        algorithm.setArg(0, "tasks", tasks[i].size());
+
         // for each file
-        for (int j = start; j <= end; ++j)
+        for (size_t j = 0; j < tasks[i].size(); ++j)
         {
             // add it to the pool
             futures.emplace_back(
-                tp.enqueue(&flowshop, j, i)
+                tp.enqueue(&flowshop, tasks[i][j], i, &batch)
             );
         }
 
-        // join the threads
-        for (int j = 0; j < futures.size(); ++j)
-            int val = futures[j].get();
+        // join the threads, the main thread waits at the barrier
+        {
+            TraceScope barrier("barrier", "batch");
+            for (int j = 0; j < futures.size(); ++j)
+                int val = futures[j].get();
+        }
 
         // clear future list
         futures.clear();
@@ -100,42 +232,237 @@ void runFlowshop()
         else if (i == 2) cout << "FSSB has completed\n";
         else if (i == 3) cout << "FSSNW has completed\n";
     }
+
+    // wait for the last results to reach the disk
+    writer.finish();
+    metrics.stop();
+    writer.report();
+    reportBatch(writer.getWritten(), chrono::duration<double, milli>(chrono::steady_clock::now() - batchStart).count(),
+                cpuTime() - cpuStart, writer.getTotals());
+    if (useSummary)
+    {
+        summary.close();
+        summary.report();
+    }
+    if (usePublisher)
+        publisher.report();
+    if (loader != nullptr)
+    {
+        loader->report();
+        delete loader;
+    }
+    if (cache != nullptr)
+    {
+        cache->complete();
+        cache->report();
+        delete cache;
+    }
+    Matrix::reportParsing();
+
+    if (tracing)
+        Trace::finish(tracePath);
 }
 
 /**
- * @brief Optimizes a dataset using the NEH algorithm
+ * @brief Optimizes a dataset and hands the result to the batch's writer
  * 
  * @param datafile  The dataset to read from
  * @param alg       The FSS algorithm to use
+ * @param batch     The thread pool and writer of the batch
  * @return int      The exit code of the function. Primarily for
  *                      thread pooling.
  */
-int flowshop(const int datafile, const int alg)
+int flowshop(const int datafile, const int alg, Batch* batch)
 {
-    // create a matrix for job times and one for completion times
-    Matrix* jobs = new Matrix(datafile);
-    Matrix* comp = new Matrix(jobs->getRows(), jobs->getCols());
+    batch->writer->push(solve(datafile, alg, batch));
+    Metrics::count(METRIC_TASKS);
+    return 0;
+}
 
-    // create a memory object to record data
+/**
+ * @brief Optimizes a dataset using the NEH algorithm, or by splitting it into
+ *          blocks of jobs when decomposition is turned on
+ * 
+ * @param datafile  The dataset to read from
+ * @param alg       The FSS algorithm to use
+ * @param batch     The thread pool and writer of the batch
+ * @return Result*  The record of the result (the sequence, not the instance)
+ */
+Result* solve(const int datafile, const int alg, Batch* batch)
+{
+    TraceScope task("task", "task");
+    task.setArg(0, "datafile", datafile);
+    task.setArg(1, "alg", alg);
+
+    // create a memory object to record data, timing each phase of the task
     Memory* mem = new Memory();
+    mem->startPhase();
+
+    // count the hardware events of the whole task on this thread
+    Counters* counters = batch->counting ? Counters::forThread() : nullptr;
+    if (counters != nullptr)
+        counters->start();
+
+    // count what the task allocates on this thread
+    if (batch->accounting)
+        Allocations::beginTask();
+
+    // create a matrix for job times, read ahead by the loader if there is one,
+    // otherwise a view into the bundle or read from the datafile
+    Matrix* jobs = nullptr;
+    {
+        TraceScope load("load", "task");
+        if (batch->loader != nullptr)
+            jobs = batch->loader->take(datafile);
+        else if (batch->bundle != nullptr)
+            jobs = batch->bundle->getMatrix(datafile);
+        if (jobs == nullptr)
+            jobs = new Matrix(datafile);
+        load.setArg(0, "jobs", jobs->getCols());
+    }
+    mem->endPhase(PHASE_LOAD);
+
+    // a result solved before, for this or an identical instance, is read back
+    uint64_t key = 0;
+    if (batch->cache != nullptr)
+    {
+        key = batch->cache->makeKey(jobs, alg);
+
+        Result* cached = new Result();
+        if (batch->cache->acquire(datafile, key, cached))
+        {
+            // only the instance was read this time
+            delete jobs;
+            cached->mem.setPhaseTime(PHASE_LOAD, mem->getPhaseTime(PHASE_LOAD));
+            if (counters != nullptr)
+            {
+                long long counts[COUNTER_COUNT];
+                counters->stop(counts);
+            }
+            delete mem;
+            Metrics::count(METRIC_CACHED);
+            return cached;
+        }
+        delete cached;
+    }
+
+    // the makespan of the original job order is reported with the result,
+    // work it out once now that the instance is read
+    Matrix* comp = new Matrix(jobs->getRows(), jobs->getCols());
+    mem->setOriginalCmax(fssType(jobs, comp, alg));
+    comp->clearMatrix();
+
+    // read in the decomposition settings
+    int blockSize = getOptions()->getInt("decompose", 0);
+    int rule      = parseSplitRule(getOptions()->getString("decomprule", "cost"));
+    int radius    = getOptions()->getInt("repair", 5);
+
+    vector<int> sequence;
+    int cmax;
+
+    if (blockSize > 0 && blockSize < jobs->getCols())
+    {
+        // solve blocks of jobs in parallel and stitch them together, the
+        // phases are timed inside
+        mem->startTimer();
+        cmax = decompose(jobs, mem, alg, batch->pool, blockSize, rule, radius, sequence);
+        mem->stopTimer();
+    }
+    else
+    {
+        // create a permutation object, reusing the completion time matrix
+        Permutation* perm = new Permutation(jobs->getCols());
+
+        // time the sort and the NEH construction
+        mem->startTimer();
+        mem->startPhase();
+        {
+            TraceScope sort("sort", "task");
+            initialize(jobs, perm); // adds the first element to the permutation
+        }
+        mem->endPhase(PHASE_SORT);
+
+        cmax = neh(jobs, comp, perm, mem, alg);
+        mem->endPhase(PHASE_NEH);
+        mem->stopTimer();
+
+        sequence.assign(perm->getBest(), perm->getBest() + perm->getSize());
+
+        delete perm;
+    }
+    delete comp;
+
+    if (counters != nullptr)
+    {
+        // added to the counts of the blocks helpers solved, if any
+        long long counts[COUNTER_COUNT];
+        counters->stop(counts);
+        mem->addCounts(counts);
+    }
+
+    if (batch->accounting)
+    {
+        long long allocs[ALLOC_STATS];
+        Allocations::endTask(allocs);
+        mem->setAllocations(allocs);
+    }
+
+    // build a compact record without the instance, so queued records don't
+    // keep it alive. At the full output level the writer reads it again.
+    Result* res   = new Result();
+    res->datafile = datafile;
+    res->alg      = alg;
+    res->cmax     = cmax;
+    res->mem      = *mem;
+    res->sequence = sequence;
 
-    // create a permutation object and initialize it
-    Permutation* perm = new Permutation(jobs->getCols());
-    initialize(jobs, perm); // adds the first element to the permutation
+    delete jobs;
+    delete mem;
+
+    if (batch->cache != nullptr)
+        batch->cache->store(key, res);
 
+    return res;
+}
+
+/**
+ * @brief Builds a job sequence with the NEH algorithm. Each job (from the
+ *          most to the least total work) is tried in every position of the
+ *          sequence built so far and left where the makespan is lowest.
+ * 
+ * @param jobs  The matrix of job run times
+ * @param comp  A matrix to hold the completion times while evaluating
+ * @param perm  The permutation object, already holding its first job
+ * @param mem   Records the number of evaluations
+ * @param alg   The FSS algorithm to use
+ * @return int  The makespan of the final sequence (also in perm's best)
+ */
+int neh(Matrix* jobs, Matrix* comp, Permutation* perm, Memory* mem, const int alg)
+{
     // initialize randomization
     random_device rd;
     mt19937 mt(rd());
     uniform_real_distribution<double> distr(0, 1);
 
-    // start a timer
-    mem->startTimer();
+    // a single job needs no insertion
+    if (perm->getSize() == 1)
+    {
+        perm->setCurrentToBest();
+        perm->setBestVal(fssTypePerm(jobs, comp, perm, alg));
+        mem->incrFuncCalls();
+        return perm->getBestVal();
+    }
 
     // for every other element to be permutated
     for (int j = 1; j < jobs->getCols(); ++j)
     {
         int curBest = INT_MAX; // holds best val of the iteration
 
+        // each insertion is one batch of evaluations on the timeline
+        TraceScope step("neh-step", "neh");
+        step.setArg(0, "job", j);
+        step.setArg(1, "evaluations", j + 1);
+
         // add the next element
         perm->addElement(perm->getJobOrder(j));
 
@@ -154,7 +481,7 @@ int flowshop(const int datafile, const int alg)
                 perm->setCurrentToBest();   // save the current permutation
             }
             // if they're the same randomly select one to keep
-            else if (fit = curBest)
+            else if (fit == curBest)
             {
                 if (distr(mt) < 0.5)
                 {
@@ -170,26 +497,9 @@ int flowshop(const int datafile, const int alg)
         // save the best fitness and permutation
         perm->setBestVal(curBest);
         perm->setBestToCurrent();
-
-        // rerun the flowshop to store the correct data to $comp
-        comp->clearMatrix();
     }
 
-    // stop the timer and record the timer taken
-    mem->stopTimer();
-
-    // rerun to have the correct info in comp
-    int temp = fssTypePerm(jobs, comp, perm, alg);
-
-    // print all the data to files
-    mem->writeAllData(jobs, comp, perm, alg, datafile); // write data to a file
-
-    // delete the objects
-    delete jobs;
-    delete comp;
-    delete perm;
-
-    return 0;
+    return perm->getBestVal();
 }
 
 /**
@@ -223,6 +533,22 @@ int fssType(Matrix* jobs, Matrix* comp, const int alg)
  */
 int fssTypePerm(Matrix* jobs, Matrix* comp, Permutation* perm, const int alg)
 {
+    // with metrics on, each evaluation is timed into its thread's histogram
+    if (Metrics::isEnabled())
+    {
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        int cmax = 0;
+        switch(alg)
+        {
+            case 1: cmax = fssPerm(jobs, comp, perm);   break;
+            case 2: cmax = fssbPerm(jobs, comp, perm);  break;
+            case 3: cmax = fssnwPerm(jobs, comp, perm); break;
+        }
+        Metrics::recordEvaluation(jobs->getCols(),
+            chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count());
+        return cmax;
+    }
+
     switch(alg)
     {
         case 1: return fssPerm(jobs, comp, perm);
@@ -293,3 +619,132 @@ void initParameters(int &start, int &end, int &algStart, int &algEnd)
     // close the file
     file.close();
 }
+
+/**
+ * @brief Opens the instance bundle named by the "bundle" option
+ * 
+ * @param bundle    The bundle to open
+ * @return true     If a bundle is in use, false if the option is off
+ */
+bool openBundle(Bundle* bundle)
+{
+    string path = getOptions()->getString("bundle", "none");
+    if (path.empty() || path == "none")
+        return false;
+
+    if (!bundle->open(path))
+    {
+        cout << "Instance bundle could not be opened, exiting program\n";
+        exit(EXIT_FAILURE);
+    }
+
+    return true;
+}
+
+/**
+ * @brief Lists the datafiles a batch runs. Without a bundle that is every
+ *          file from start to end, with one it is every instance of the
+ *          bundle in that range whose tag matches the "tag" option.
+ * 
+ * @param start         The first datafile number
+ * @param end           The last datafile number
+ * @param bundle        The bundle of the batch, or nullptr
+ * @return vector<int>  The datafile numbers, in order
+ */
+vector<int> selectDatafiles(const int start, const int end, Bundle* bundle)
+{
+    vector<int> datafiles;
+
+    if (bundle == nullptr)
+    {
+        for (int j = start; j <= end; ++j)
+            datafiles.push_back(j);
+        return datafiles;
+    }
+
+    string tag = getOptions()->getString("tag", "all");
+    return bundle->select(start, end, (tag == "all") ? "" : tag);
+}
+
+/**
+ * @brief Opens the result cache named by the "cache" option. Everything
+ *          besides the instance and algorithm that changes a result is part
+ *          of the cache's keys, so changing a setting never reuses results
+ *          solved with the old one.
+ * 
+ * @param useManifest       Whether this process keeps the batch's manifest
+ * @return ResultCache*     The cache, or nullptr if the option is off
+ */
+ResultCache* openCache(const bool useManifest)
+{
+    string path = getOptions()->getString("cache", "none");
+    if (path.empty() || path == "none")
+        return nullptr;
+
+    string settings = "neh decompose=" + to_string(getOptions()->getInt("decompose", 0));
+    settings += " decomprule=" + getOptions()->getString("decomprule", "cost");
+    settings += " repair=" + to_string(getOptions()->getInt("repair", 5));
+
+    return new ResultCache(path, settings, useManifest);
+}
+
+/**
+ * @brief Opens the shared memory ring named by the "publish" option
+ * 
+ * @param publisher The publisher to open
+ * @return true     If results will be published
+ */
+bool openPublisher(Publisher* publisher)
+{
+    string name = getOptions()->getString("publish", "none");
+    if (name.empty() || name == "none")
+        return false;
+
+    return publisher->open(name, getOptions()->getInt("publishslots", 1024));
+}
+
+/**
+ * @brief Returns the CPU time used so far by every thread of this process and
+ *          by its child processes that have finished
+ * 
+ * @return double The CPU time (ms)
+ */
+double cpuTime()
+{
+    struct rusage self, children;
+    getrusage(RUSAGE_SELF, &self);
+    getrusage(RUSAGE_CHILDREN, &children);
+
+    double sec = self.ru_utime.tv_sec + self.ru_stime.tv_sec + children.ru_utime.tv_sec + children.ru_stime.tv_sec;
+    double usec = self.ru_utime.tv_usec + self.ru_stime.tv_usec + children.ru_utime.tv_usec + children.ru_stime.tv_usec;
+
+    return sec * 1000 + usec / 1000;
+}
+
+/**
+ * @brief Prints the wall and CPU time of a batch and writes them, with the
+ *          phase times summed over every task, to results/batch.txt
+ * 
+ * @param tasks     How many tasks the batch finished
+ * @param wallTime  How long the batch took (ms)
+ * @param cpuTime   The CPU time the batch used (ms)
+ * @param totals    The function calls and times summed over every task
+ */
+void reportBatch(const long tasks, const double wallTime, const double cpuTime, Memory* totals)
+{
+    cout << "Batch: " << tasks << " task(s) in " << wallTime << " ms (wall), " << cpuTime << " ms (CPU)\n";
+
+    // with allocations on, what the tasks allocated and what the process holds
+    if (totals->hasAllocations())
+    {
+        cout << "Memory: " << totals->getAllocation(ALLOC_COUNT) << " allocation(s) of ";
+        cout << totals->getAllocation(ALLOC_BYTES) / 1048576.0 << " MB by the tasks, largest task peak ";
+        cout << totals->getAllocation(ALLOC_PEAK) / 1048576.0 << " MB, ";
+        cout << Allocations::getLive() / 1048576.0 << " MB still live (peak ";
+        cout << Allocations::getPeak() / 1048576.0 << " MB), RSS " << Allocations::residentKB() / 1024.0;
+        cout << " MB (high-water " << Allocations::peakResidentKB() / 1024.0 << " MB)\n";
+    }
+
+    OutputBuffer out;
+    totals->writeBatchData(tasks, wallTime, cpuTime, &out);
+}
@@ -0,0 +1,286 @@
+/**
+ * @file wavefront.cpp
+ * @author Matthew Harker
+ * @brief Evaluates a single (very large) job sequence in parallel. The
+ *          completion matrix is cut into tiles, and every tile whose
+ *          neighbours are finished is computed at the same time on the
+ *          thread pool. The recurrences are the same as fssPerm() and
+ *          fssbPerm(), so the resulting matrix is identical.
+ * @version 1.0
+ * @date 2019-06-05
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+#include <algorithm>
+#include <future>
+#include <vector>
+
+#include "wavefront.h"
+
+using namespace std;
+
+// the bounds of one tile, rows r0 .. r1-1 and columns c0 .. c1-1
+struct Tile {
+    int r0, r1, c0, c1;
+};
+
+/**
+ * @brief Lists the tiles of one anti-diagonal of the tile grid. Tile (i, j)
+ *          only needs tiles (i-1, j) and (i, j-1), so all the tiles of one
+ *          anti-diagonal can run at the same time.
+ *
+ *          When skewed, row i of the tile grid is a row of the skewed matrix
+ *          (row + column), which turns the tiles into parallelograms. Tiles
+ *          that miss the matrix entirely are left out.
+ *
+ * @param w         The anti-diagonal, 0 to numI + numJ - 2
+ * @param tileRows  The height of a tile
+ * @param tileCols  The width of a tile
+ * @param rows      The number of rows of the matrix
+ * @param cols      The number of columns of the matrix
+ * @param skewed    Whether the tile rows are rows of the skewed matrix
+ * @param tiles     Receives the tiles
+ * @return int      The number of anti-diagonals
+ */
+static int waveTiles(const int w, const int tileRows, const int tileCols, const int rows, const int cols,
+                     const bool skewed, vector<Tile>& tiles)
+{
+    int span = skewed ? rows + cols - 1 : rows;
+    int numI = (span + tileRows - 1) / tileRows;
+    int numJ = (cols + tileCols - 1) / tileCols;
+
+    tiles.clear();
+    for (int j = max(0, w - numI + 1); j < numJ && j <= w; ++j)
+    {
+        int i  = w - j;
+        int r0 = i * tileRows, r1 = min(span, r0 + tileRows);
+        int c0 = j * tileCols, c1 = min(cols, c0 + tileCols);
+
+        // skewed rows c0 .. c1+rows-2 are the only ones these columns use
+        if (skewed && (r1 <= c0 || r0 > c1 + rows - 2))
+            continue;
+
+        tiles.push_back({ r0, r1, c0, c1 });
+    }
+
+    return numI + numJ - 1;
+}
+
+/**
+ * @brief Runs every tile of the completion matrix, one anti-diagonal of tiles
+ *          at a time
+ *
+ * @param tileRows  The height of a tile
+ * @param tileCols  The width of a tile
+ * @param rows      The number of rows of the matrix
+ * @param cols      The number of columns of the matrix
+ * @param skewed    Whether the tile rows are rows of the skewed matrix
+ * @param tp        The thread pool to run the tiles on
+ * @param tile      The function that computes one tile (r0, r1, c0, c1)
+ */
+static void runWaves(const int tileRows, const int tileCols, const int rows, const int cols,
+                     const bool skewed, ThreadPool* tp, function<void(int, int, int, int)> tile)
+{
+    vector<Tile> tiles;
+    vector< future<void> > futures;
+
+    int waves = 1;
+    for (int w = 0; w < waves; ++w)
+    {
+        waves = waveTiles(w, tileRows, tileCols, rows, cols, skewed, tiles);
+        for (size_t t = 0; t < tiles.size(); ++t)
+            futures.emplace_back(tp->enqueue(tile, tiles[t].r0, tiles[t].r1, tiles[t].c0, tiles[t].c1));
+
+        // the next anti-diagonal needs all of these finished
+        for (size_t f = 0; f < futures.size(); ++f)
+            futures[f].get();
+        futures.clear();
+    }
+}
+
+/**
+ * @brief Returns how many tiles an anti-diagonal has on average, which is
+ *          the most threads the wavefront can keep busy
+ *
+ * @param tileRows  The height of a tile
+ * @param tileCols  The width of a tile
+ * @param rows      The number of rows of the matrix
+ * @param cols      The number of columns of the matrix
+ * @param skewed    Whether the tiles are laid out on the skewed matrix (FSSB)
+ * @return double   The mean tiles per anti-diagonal
+ */
+double waveWidth(const int tileRows, const int tileCols, const int rows, const int cols, const bool skewed)
+{
+    vector<Tile> tiles;
+    long total = 0, used = 0;
+
+    int waves = 1;
+    for (int w = 0; w < waves; ++w)
+    {
+        waves = waveTiles(w, tileRows, tileCols, rows, cols, skewed, tiles);
+        total += tiles.size();
+        used  += !tiles.empty();
+    }
+
+    return (used > 0) ? (double)total / used : 0;
+}
+
+/**
+ * @brief Picks the side of the square FSSB tiles. The skewed matrix is a
+ *          band as high as the number of machines, and an anti-diagonal of
+ *          s x s tiles holds about (machines + s) / 2s of them, so the side
+ *          is made small enough to give every thread a tile, and no smaller
+ *          than needed since every tile costs a task.
+ *
+ * @param machines  The number of machines (rows)
+ * @param threads   The number of threads to keep busy
+ * @return int      The side of a tile
+ */
+int fssbTileSide(const int machines, const int threads)
+{
+    if (threads <= 1)
+        return WAVE_FSSB_TILE_MAX;
+
+    int side = machines / (2 * threads - 1);
+    return max(WAVE_FSSB_TILE_MIN, min(WAVE_FSSB_TILE_MAX, side));
+}
+
+/**
+ * @brief The basic flowshop scheduling algorithm, evaluated as a wavefront of
+ *          tiles on the thread pool. Tiles on the same anti-diagonal run in
+ *          parallel.
+ *
+ * @param jobs      The matrix of job run times
+ * @param compTime  The matrix of job completion times
+ * @param perm      The permutation object
+ * @param tp        The thread pool to evaluate on
+ * @param tileRows  The height of a tile
+ * @param tileCols  The width of a tile
+ * @return int      The resulting makespan of the permutation
+ */
+int fssWavefront(Matrix* jobs, Matrix* compTime, Permutation* perm, ThreadPool* tp,
+                 const int tileRows, const int tileCols)
+{
+    int curSize = perm->getCurSize();
+    const int* order = perm->getPerm();
+
+    // a tile needs the tile above it and the tile to the left of it
+    runWaves(tileRows, tileCols, jobs->getRows(), curSize, false, tp,
+        [jobs, compTime, order](int r0, int r1, int c0, int c1)
+        {
+            fssTile(jobs, compTime, order, r0, r1, c0, c1);
+        });
+
+    return compTime->getVal(compTime->getRows()-1, curSize-1);
+}
+
+/**
+ * @brief Flowshop scheduling with blocking, evaluated as a wavefront of tiles
+ *          on the thread pool. A blocking cell needs the cell above it and
+ *          the cell below and to the left of it, so the tiles are laid out
+ *          on the skewed matrix (row + column), where those become the cell
+ *          above and the cell to the left.
+ *
+ *          The skewed matrix is a diagonal band only as high as the number
+ *          of machines, so the parallelism is bounded by the machines, not
+ *          the jobs: wide tiles leave about one tile per anti-diagonal. Use
+ *          square tiles from fssbTileSide().
+ *
+ * @param jobs      The matrix of job run times
+ * @param compTime  The matrix of job completion times
+ * @param perm      The permutation object
+ * @param tp        The thread pool to evaluate on
+ * @param tileRows  The height of a tile
+ * @param tileCols  The width of a tile
+ * @return int      The resulting makespan of the permutation
+ */
+int fssbWavefront(Matrix* jobs, Matrix* compTime, Permutation* perm, ThreadPool* tp,
+                  const int tileRows, const int tileCols)
+{
+    int curSize = perm->getCurSize();
+    const int* order = perm->getPerm();
+
+    runWaves(tileRows, tileCols, jobs->getRows(), curSize, true, tp,
+        [jobs, compTime, order](int r0, int r1, int c0, int c1)
+        {
+            fssbTile(jobs, compTime, order, r0, r1, c0, c1);
+        });
+
+    return compTime->getVal(compTime->getRows()-1, curSize-1);
+}
+
+/**
+ * @brief Computes one tile of the FSS completion matrix. Same recurrence as
+ *          baseTimeFSSPerm().
+ *
+ * @param jobs      The job run time matrix
+ * @param compTime  The matrix of job completion times
+ * @param order     The job sequence
+ * @param r0        The first row of the tile
+ * @param r1        One past the last row of the tile
+ * @param c0        The first column of the tile
+ * @param c1        One past the last column of the tile
+ */
+void fssTile(Matrix* jobs, Matrix* compTime, const int* order, const int r0, const int r1,
+             const int c0, const int c1)
+{
+    for (int r = r0; r < r1; ++r)
+    {
+        const int* proc = jobs->getRow(r);
+        const int* up   = (r > 0) ? compTime->getRow(r-1) : nullptr;
+        int* cur        = compTime->getRow(r);
+
+        // the value to the left of the tile (0 on the first column)
+        int left = (c0 > 0) ? cur[c0-1] : 0;
+
+        for (int c = c0; c < c1; ++c)
+        {
+            int base = (up != nullptr) ? max(left, up[c]) : left;
+            left = base + proc[order[c]];
+            cur[c] = left;
+        }
+    }
+}
+
+/**
+ * @brief Computes one tile of the FSSB completion matrix. Same recurrence as
+ *          newTimeFSSBPerm(), column by column. The rows of the tile are
+ *          rows of the skewed matrix, so column c holds rows r0-c .. r1-1-c.
+ *
+ * @param jobs      The job run time matrix
+ * @param compTime  The matrix of job completion times
+ * @param order     The job sequence
+ * @param r0        The first skewed row of the tile
+ * @param r1        One past the last skewed row of the tile
+ * @param c0        The first column of the tile
+ * @param c1        One past the last column of the tile
+ */
+void fssbTile(Matrix* jobs, Matrix* compTime, const int* order, const int r0, const int r1,
+              const int c0, const int c1)
+{
+    int last = compTime->getRows() - 1;
+
+    for (int c = c0; c < c1; ++c)
+    {
+        int job = order[c];
+
+        for (int r = max(0, r0 - c); r < min(last + 1, r1 - c); ++r)
+        {
+            int p = jobs->getRow(r)[job];
+            int* cur = compTime->getRow(r);
+            int val;
+
+            if (c == 0)
+                val = (r == 0) ? p : compTime->getRow(r-1)[0] + p;
+            else if (r == last)
+                val = compTime->getRow(r-1)[c] + p;
+            else if (r == 0)
+                val = max(cur[c-1] + p, compTime->getRow(1)[c-1]);
+            else
+                val = max(compTime->getRow(r+1)[c-1], compTime->getRow(r-1)[c] + p);
+
+            cur[c] = val;
+        }
+    }
+}
@@ -0,0 +1,312 @@
+/**
+ * @file bench.cpp
+ * @author Matthew Harker
+ * @brief Micro-benchmarks of the evaluation kernels (fssPerm, fssbPerm,
+ *          fssnwPerm), of one NEH insertion step, of a whole NEH
+ *          construction, and of a whole task through flowshop() (loading,
+ *          the original makespan, NEH, and handing the result to a writer),
+ *          on random instances of every class of 5, 10, and 20 machines by
+ *          20, 50, 100, and 200 jobs. Each benchmark is
+ *          sampled several times; the mean, variance, and standard
+ *          deviation of the time per evaluation are written as JSON so runs
+ *          of different builds can be compared.
+ *
+ *          usage: bench.out [samples] [output] [minMs]
+ * @version 1.0
+ * @date 2019-06-14
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+#include "Batch.h"
+#include "Bundle.h"
+#include "flowshop.h"
+
+using namespace std;
+
+// the statistics of one benchmark
+struct Stats {
+    string name;        // what was measured
+    int    machines;    // the rows of the instance
+    int    jobs;        // the columns of the instance
+    int    samples;     // how many samples were taken
+    long   evals;       // evaluations in each sample
+    double mean;        // mean nanoseconds per evaluation
+    double variance;    // variance of the nanoseconds per evaluation
+};
+
+// the instances are packed into this bundle for the flowshop() benchmarks
+const string BENCH_BUNDLE = "results/bench.bundle";
+
+/**
+ * @brief Creates a random instance with Taillard's distribution (1 to 99)
+ *
+ * @param rows      The number of machines
+ * @param cols      The number of jobs
+ * @param seed      The seed, so every build measures the same instances
+ * @return Matrix*  The instance
+ */
+static Matrix* randomInstance(const int rows, const int cols, const unsigned seed)
+{
+    mt19937 mt(seed);
+    uniform_int_distribution<int> times(1, 99);
+
+    Matrix* jobs = new Matrix(rows, cols);
+    for (int r = 0; r < rows; ++r)
+        for (int c = 0; c < cols; ++c)
+            jobs->setVal(times(mt), r, c);
+    jobs->generateJobCosts();
+
+    return jobs;
+}
+
+/**
+ * @brief Times a piece of work. It is first repeated until one sample takes
+ *          at least minMs, then that many repeats are timed for each sample.
+ *
+ * @param name          What is measured
+ * @param rows          The machines of the instance
+ * @param cols          The jobs of the instance
+ * @param samples       How many samples to take
+ * @param minMs         The shortest a sample may be
+ * @param evalsPerRun   How many evaluations one run of work does
+ * @param work          The work, run once per call
+ * @return Stats        The statistics per evaluation
+ */
+static Stats measure(const string name, const int rows, const int cols, const int samples, const double minMs,
+                     const long evalsPerRun, function<void()> work)
+{
+    // find how many runs make a long enough sample
+    long runs = 1;
+    for (;;)
+    {
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        for (long i = 0; i < runs; ++i)
+            work();
+        double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+        if (ms >= minMs || runs >= (1L << 30))
+            break;
+        runs = (ms <= 0) ? runs * 16 : max(runs + 1, (long)(runs * minMs / ms * 1.2));
+    }
+
+    vector<double> perEval;
+    for (int s = 0; s < samples; ++s)
+    {
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        for (long i = 0; i < runs; ++i)
+            work();
+        double ns = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+
+        perEval.push_back(ns / (runs * evalsPerRun));
+    }
+
+    Stats st;
+    st.name     = name;
+    st.machines = rows;
+    st.jobs     = cols;
+    st.samples  = samples;
+    st.evals    = runs * evalsPerRun;
+    st.mean     = 0;
+    st.variance = 0;
+
+    for (size_t i = 0; i < perEval.size(); ++i)
+        st.mean += perEval[i];
+    st.mean /= perEval.size();
+
+    for (size_t i = 0; i < perEval.size(); ++i)
+        st.variance += (perEval[i] - st.mean) * (perEval[i] - st.mean);
+    if (perEval.size() > 1)
+        st.variance /= perEval.size() - 1;
+
+    return st;
+}
+
+/**
+ * @brief Writes the statistics as one JSON object
+ *
+ * @param out   Where to write them
+ * @param st    The statistics
+ */
+static void writeJson(ostream& out, const Stats& st)
+{
+    double stddev = sqrt(st.variance);
+
+    out << "    { \"name\": \"" << st.name << "\", \"machines\": " << st.machines << ", \"jobs\": " << st.jobs;
+    out << ", \"samples\": " << st.samples << ", \"evals_per_sample\": " << st.evals;
+    out << ", \"ns_per_eval\": " << st.mean << ", \"variance_ns2\": " << st.variance;
+    out << ", \"stddev_ns\": " << stddev << ", \"evals_per_sec\": " << ((st.mean > 0) ? 1e9 / st.mean : 0) << " }";
+}
+
+int main(int argc, char** argv)
+{
+    int samples   = (argc > 1) ? max(2, atoi(argv[1])) : 10;
+    string output = (argc > 2) ? argv[2] : "";
+    double minMs  = (argc > 3) ? atof(argv[3]) : 20;
+
+    const int machineCounts[] = { 5, 10, 20 };
+    const int jobCounts[]     = { 20, 50, 100, 200 };
+    const char* kernels[]     = { "", "fssPerm", "fssbPerm", "fssnwPerm" };
+
+    vector<Stats> results;
+
+    // flowshop() finds its instance by number, so every instance is also
+    // packed into a bundle, numbered by its seed
+    vector<int> ids;
+    vector<Matrix*> instances;
+    for (int j = 0; j < 4; ++j)
+    {
+        for (int m = 0; m < 3; ++m)
+        {
+            ids.push_back(1000 * machineCounts[m] + jobCounts[j]);
+            instances.push_back(randomInstance(machineCounts[m], jobCounts[j], ids.back()));
+        }
+    }
+
+    mkdir("results", 0755);
+    bool packed = writeBundle(BENCH_BUNDLE, ids, instances, vector<string>());
+    for (size_t i = 0; i < instances.size(); ++i)
+        delete instances[i];
+
+    Bundle bundle;
+    if (!packed || !bundle.open(BENCH_BUNDLE))
+    {
+        cout << "Could not write the instances to " << BENCH_BUNDLE << "\n";
+        return 1;
+    }
+    unlink(BENCH_BUNDLE.c_str());
+
+    // a batch of one: tasks run on this thread, the writer on its own, and
+    // the pool is only there for decomposition. The options keep their
+    // defaults, so nothing is written to disk.
+    ThreadPool tp(1);
+    ResultWriter writer(2, nullptr, nullptr, &bundle);
+
+    Batch batch;
+    batch.pool       = &tp;
+    batch.writer     = &writer;
+    batch.bundle     = &bundle;
+    batch.loader     = nullptr;
+    batch.cache      = nullptr;
+    batch.counting   = false;
+    batch.accounting = false;
+
+    for (int j = 0; j < 4; ++j)
+    {
+        for (int m = 0; m < 3; ++m)
+        {
+            int rows = machineCounts[m];
+            int cols = jobCounts[j];
+
+            Matrix* jobs = randomInstance(rows, cols, 1000 * rows + cols);
+            Matrix* comp = new Matrix(rows, cols);
+
+            // a random full sequence for the kernels
+            vector<int> order(cols);
+            for (int c = 0; c < cols; ++c)
+                order[c] = c;
+            shuffle(order.begin(), order.end(), mt19937(cols));
+
+            Permutation* full = new Permutation(cols);
+            for (int c = 0; c < cols; ++c)
+                full->addElement(order[c]);
+
+            for (int alg = 1; alg <= 3; ++alg)
+                results.push_back(measure(kernels[alg], rows, cols, samples, minMs, 1,
+                    [&] { fssTypePerm(jobs, comp, full, alg); }));
+
+            // one NEH step: insert a job into every position of a half built
+            // sequence, the way neh() does (clearing comp before each one)
+            int half = cols / 2;
+            Permutation* step = new Permutation(cols);
+            for (int c = 0; c < half; ++c)
+                step->addElement(order[c]);
+
+            for (int alg = 1; alg <= 3; ++alg)
+            {
+                results.push_back(measure(string("nehStep-") + kernels[alg], rows, cols, samples, minMs, half + 1, [&] {
+                    step->setCurSize(half);
+                    step->addElement(order[half]);
+                    for (int k = 0; k < step->getCurSize(); ++k)
+                    {
+                        comp->clearMatrix();
+                        fssTypePerm(jobs, comp, step, alg);
+                        if (step->getPos() > 0) step->nextPermutation();
+                    }
+
+                    // put the inserted job back at the end for the next run
+                    rotate(step->getPerm(), step->getPerm() + 1, step->getPerm() + half + 1);
+                }));
+            }
+
+            // a whole NEH construction, timed per evaluation it makes
+            long nehEvals = (long)cols * (cols + 1) / 2 - 1;
+            for (int alg = 1; alg <= 3; ++alg)
+            {
+                results.push_back(measure(string("neh-") + kernels[alg], rows, cols, samples, minMs, nehEvals, [&] {
+                    Permutation* perm = new Permutation(cols);
+                    Memory mem;
+                    initialize(jobs, perm);
+                    neh(jobs, comp, perm, &mem, alg);
+                    delete perm;
+                }));
+            }
+
+            // the same construction as a whole task of the batch
+            int id = 1000 * rows + cols;
+            for (int alg = 1; alg <= 3; ++alg)
+            {
+                results.push_back(measure(string("flowshop-") + kernels[alg], rows, cols, samples, minMs, nehEvals, [&] {
+                    flowshop(id, alg, &batch);
+                }));
+            }
+
+            cerr << rows << "x" << cols << " done\n";
+
+            delete step;
+            delete full;
+            delete comp;
+            delete jobs;
+        }
+    }
+
+    writer.finish();
+
+    // write the report
+    ostringstream json;
+    json << "{\n  \"benchmark\": \"flowshop kernels\",\n  \"samples\": " << samples;
+    json << ",\n  \"min_sample_ms\": " << minMs << ",\n  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        writeJson(json, results[i]);
+        json << ((i + 1 < results.size()) ? ",\n" : "\n");
+    }
+    json << "  ]\n}\n";
+
+    if (output.empty())
+    {
+        cout << json.str();
+    }
+    else
+    {
+        ofstream file(output);
+        file << json.str();
+        cout << "Wrote " << results.size() << " benchmark(s) to " << output << "\n";
+    }
+
+    return 0;
+}
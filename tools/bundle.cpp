@@ -0,0 +1,83 @@
+/**
+ * @file bundle.cpp
+ * @author Matthew Harker
+ * @brief Packs DataFiles into a single instance bundle with an index, which
+ *          the program maps once for the whole batch when the "bundle"
+ *          option names it. Each instance is tagged with its size, such as
+ *          "5x20" (machines x jobs), so a batch can select a class by tag.
+ *
+ *          usage: bundle.out [first] [last] [output]
+ * @version 1.0
+ * @date 2019-06-09
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "Bundle.h"
+#include "Matrix.h"
+
+using namespace std;
+
+int main(int argc, char** argv)
+{
+    int first       = (argc > 1) ? atoi(argv[1]) : 1;
+    int last        = (argc > 2) ? atoi(argv[2]) : 120;
+    string pathname = (argc > 3) ? argv[3] : "DataFiles/taillard.fsb";
+
+    // an empty tag lets the bundle tag each instance with its size
+    vector<int> ids;
+    for (int d = first; d <= last; ++d)
+        ids.push_back(d);
+    vector<string> tags(ids.size());
+
+    if (!writeBundle(pathname, ids, tags))
+    {
+        cout << "Could not write " << pathname << "\n";
+        return 1;
+    }
+
+    // read every instance back to make sure it matches its datafile
+    Bundle bundle;
+    if (!bundle.open(pathname) || bundle.getCount() != (int)ids.size())
+    {
+        cout << pathname << " could not be read back\n";
+        return 1;
+    }
+
+    map<string, int> classes;
+    for (size_t i = 0; i < ids.size(); ++i)
+    {
+        Matrix* file = new Matrix(ids[i]);
+        Matrix* view = bundle.getMatrix(ids[i]);
+
+        bool same = view != nullptr && view->getRows() == file->getRows() && view->getCols() == file->getCols();
+        for (int r = 0; r < file->getRows() && same; ++r)
+            same = equal(file->getRow(r), file->getRow(r) + file->getCols(), view->getRow(r));
+
+        delete file;
+        delete view;
+
+        if (!same)
+        {
+            cout << "Datafile " << ids[i] << " does not match its copy in " << pathname << "\n";
+            return 1;
+        }
+
+        const BundleEntry* entry = bundle.find(ids[i]);
+        ++classes[string(entry->tag, strnlen(entry->tag, BUNDLE_TAG_SIZE))];
+    }
+
+    cout << "Bundled " << ids.size() << " datafile(s) into " << pathname << "\n";
+    for (map<string, int>::iterator it = classes.begin(); it != classes.end(); ++it)
+        cout << "    " << it->first << ": " << it->second << "\n";
+
+    return 0;
+}
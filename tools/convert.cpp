@@ -0,0 +1,65 @@
+/**
+ * @file convert.cpp
+ * @author Matthew Harker
+ * @brief Converts text DataFiles into the binary instance format. Each
+ *          DataFiles/<n>.txt becomes DataFiles/<n>.bin, which the program
+ *          then maps instead of parsing.
+ *
+ *          usage: convert.out [first] [last]
+ * @version 1.0
+ * @date 2019-06-08
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "Instance.h"
+#include "Matrix.h"
+
+using namespace std;
+
+int main(int argc, char** argv)
+{
+    int first = (argc > 1) ? atoi(argv[1]) : 1;
+    int last  = (argc > 2) ? atoi(argv[2]) : 120;
+
+    int converted = 0;
+    for (int d = first; d <= last; ++d)
+    {
+        // always read the text version
+        Matrix* text = new Matrix(to_string(d) + ".txt");
+
+        string pathname = "DataFiles/" + to_string(d) + ".bin";
+        if (!writeInstance(pathname, text))
+        {
+            cout << "Could not write " << pathname << "\n";
+            delete text;
+            return 1;
+        }
+
+        // read it back to make sure it matches
+        Matrix* bin = new Matrix(to_string(d) + ".bin");
+        bool same = bin->getRows() == text->getRows() && bin->getCols() == text->getCols();
+        for (int r = 0; r < text->getRows() && same; ++r)
+            same = equal(text->getRow(r), text->getRow(r) + text->getCols(), bin->getRow(r));
+
+        if (!same)
+        {
+            cout << pathname << " does not match its text version\n";
+            delete text;
+            delete bin;
+            return 1;
+        }
+
+        delete text;
+        delete bin;
+        ++converted;
+    }
+
+    cout << "Converted " << converted << " datafile(s)\n";
+    return 0;
+}
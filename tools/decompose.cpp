@@ -0,0 +1,98 @@
+/**
+ * @file decompose.cpp
+ * @author Matthew Harker
+ * @brief Compares the decomposition mode against plain NEH on a range of
+ *          datafiles (by default the 200 job files) and reports the
+ *          relative difference in makespan and the time each one took.
+ *
+ *          usage: decompose.out [blockSize] [rule] [radius] [first] [last] [alg]
+ * @version 1.0
+ * @date 2019-06-06
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "decompose.h"
+#include "flowshop.h"
+
+using namespace std;
+
+int main(int argc, char** argv)
+{
+    int blockSize = (argc > 1) ? atoi(argv[1]) : 50;
+    int rule      = parseSplitRule((argc > 2) ? argv[2] : "cost");
+    int radius    = (argc > 3) ? atoi(argv[3]) : 5;
+    int first     = (argc > 4) ? atoi(argv[4]) : 91;
+    int last      = (argc > 5) ? atoi(argv[5]) : 110;
+    int alg       = (argc > 6) ? atoi(argv[6]) : 1;
+
+    if (blockSize < 1 || alg < 1 || alg > 3)
+    {
+        cout << "usage: decompose.out [blockSize] [index|cost|stride] [radius] [first] [last] [1-3]\n";
+        return 1;
+    }
+
+    ThreadPool tp(thread::hardware_concurrency());
+
+    cout << "datafile,jobs,neh_cmax,neh_ms,decomp_cmax,decomp_ms,rpd\n";
+
+    double totalRpd = 0;
+    double nehTime = 0, decompTime = 0;
+    int count = 0;
+
+    for (int d = first; d <= last; ++d)
+    {
+        Matrix* jobs = new Matrix(d);
+
+        // the full NEH baseline
+        Memory nehMem;
+        Matrix* comp = new Matrix(jobs->getRows(), jobs->getCols());
+        Permutation* perm = new Permutation(jobs->getCols());
+        initialize(jobs, perm);
+
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        int nehCmax = neh(jobs, comp, perm, &nehMem, alg);
+        double nehMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+        delete comp;
+        delete perm;
+
+        // the decomposition
+        Memory decMem;
+        vector<int> sequence;
+
+        start = chrono::steady_clock::now();
+        int decCmax = decompose(jobs, &decMem, alg, &tp, blockSize, rule, radius, sequence);
+        double decMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+        // make sure the reported makespan belongs to the sequence
+        if (evalSequence(jobs, alg, sequence, 0, sequence.size()) != decCmax)
+            cout << "warning: datafile " << d << " makespan does not match its sequence\n";
+
+        double rpd = 100.0 * (decCmax - nehCmax) / nehCmax;
+        cout << d << "," << jobs->getCols() << "," << nehCmax << "," << nehMs << ",";
+        cout << decCmax << "," << decMs << "," << rpd << "\n";
+
+        totalRpd   += rpd;
+        nehTime    += nehMs;
+        decompTime += decMs;
+        ++count;
+
+        delete jobs;
+    }
+
+    if (count > 0)
+    {
+        cout << "\nAverage deviation from full NEH: " << totalRpd / count << " %\n";
+        cout << "Total time: NEH " << nehTime << " ms, decomposition " << decompTime << " ms\n";
+    }
+
+    return 0;
+}
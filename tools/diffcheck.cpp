@@ -0,0 +1,524 @@
+/**
+ * @file diffcheck.cpp
+ * @author Matthew Harker
+ * @brief Differential test of the evaluation kernels. Makes random instances
+ *          and job sequences and checks that every kernel (fssPerm, fssbPerm,
+ *          fssnwPerm, the wavefront evaluators, evalSequence) gives the same
+ *          Cmax and completion matrix as the reference fss(), fssb(), and
+ *          fssnw() on the jobs in sequence order. Every schedule is also
+ *          checked against the rules of its flowshop, and NEH and
+ *          decomposition are checked to return a real sequence with the Cmax
+ *          they claim. A failing case is shrunk to the smallest instance that
+ *          still fails and written out.
+ *
+ *          usage: diffcheck.out [cases] [seed] [maxMachines] [maxJobs]
+ * @version 1.0
+ * @date 2019-06-17
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <sys/stat.h>
+#include <thread>
+#include <vector>
+
+#include "decompose.h"
+#include "flowshop.h"
+#include "Generator.h"
+#include "OutputBuffer.h"
+#include "ThreadPool.h"
+#include "wavefront.h"
+
+using namespace std;
+
+static const char* ALG_NAMES[] = { "", "FSS", "FSSB", "FSSNW" };
+
+// one test: an instance, a job sequence, and how much of it is evaluated
+struct Case {
+    int  alg;                       // the flowshop (1 FSS, 2 FSSB, 3 FSSNW)
+    vector< vector<int> > times;    // the processing times, one row per machine
+    vector<int> order;              // the job sequence, every job once
+    int  size;                      // how many jobs of the sequence are evaluated
+    bool dirty;                     // whether the kernel's matrix starts full of garbage
+};
+
+// an evaluator that is checked against the reference
+struct Kernel {
+    string name;    // how it is reported
+    int    alg;     // the flowshop it evaluates
+    bool   matrix;  // whether it fills in a completion matrix to compare
+    function<int(Matrix*, Matrix*, Permutation*)> eval;
+};
+
+/**
+ * @brief Builds the job matrix of a case
+ *
+ * @param c         The case
+ * @return Matrix*  The processing times
+ */
+static Matrix* makeJobs(const Case& c)
+{
+    Matrix* jobs = new Matrix(c.times.size(), c.times[0].size());
+    for (size_t r = 0; r < c.times.size(); ++r)
+        copy(c.times[r].begin(), c.times[r].end(), jobs->getRow(r));
+
+    return jobs;
+}
+
+/**
+ * @brief Checks a schedule against the rules of its flowshop. For FSS and
+ *          FSSNW the matrix holds when each job finishes on each machine, for
+ *          FSSB when it leaves the machine (which may be after it finishes).
+ *          Every operation must also start as early as the rules allow.
+ *
+ * @param alg       The flowshop (1 FSS, 2 FSSB, 3 FSSNW)
+ * @param p         The processing times, in sequence order
+ * @param comp      The completion (or departure) times
+ * @param cols      How many jobs were evaluated
+ * @return string   An empty string if the schedule is valid, otherwise the problem
+ */
+static string checkSchedule(const int alg, Matrix* p, Matrix* comp, const int cols)
+{
+    int rows = p->getRows();
+    ostringstream err;
+
+    for (int c = 0; c < cols; ++c)
+    {
+        int slack = -1; // how far the no-wait job could move earlier
+
+        for (int r = 0; r < rows; ++r)
+        {
+            int time  = p->getVal(r, c);
+            int end   = comp->getVal(r, c);
+            int prevJob  = (c > 0) ? comp->getVal(r, c - 1) : 0;
+            int prevMach = (r > 0) ? comp->getVal(r - 1, c) : 0;
+
+            if (alg == 1)
+            {
+                int start = end - time;
+                if (start < prevMach || start < prevJob)
+                    err << "operation (" << r << "," << c << ") starts at " << start << " before its machine or job is free";
+                else if (start != max(prevJob, prevMach))
+                    err << "operation (" << r << "," << c << ") starts at " << start << ", it could start at " << max(prevJob, prevMach);
+            }
+            else if (alg == 2)
+            {
+                // a job enters a machine when it leaves the one before
+                int start = (r > 0) ? prevMach : prevJob;
+                int below = (r + 1 < rows && c > 0) ? comp->getVal(r + 1, c - 1) : 0;
+
+                if (start < prevJob)
+                    err << "job " << c << " enters machine " << r << " at " << start << " before job " << c - 1 << " leaves it";
+                else if (end < start + time)
+                    err << "operation (" << r << "," << c << ") leaves at " << end << " before it is processed";
+                else if (end < below)
+                    err << "operation (" << r << "," << c << ") leaves at " << end << " while machine " << r + 1 << " is still blocked";
+                else if (end != max(start + time, below))
+                    err << "operation (" << r << "," << c << ") leaves at " << end << ", it could leave at " << max(start + time, below);
+            }
+            else
+            {
+                int start = end - time;
+                if (start < prevJob)
+                    err << "operation (" << r << "," << c << ") starts at " << start << " before its machine is free";
+                else if (r > 0 && start != prevMach)
+                    err << "job " << c << " waits between machines " << r - 1 << " and " << r;
+
+                if (slack < 0 || start - prevJob < slack)
+                    slack = start - prevJob;
+            }
+
+            if (!err.str().empty())
+                return err.str();
+        }
+
+        if (alg == 3 && slack != 0)
+        {
+            err << "job " << c << " could start " << slack << " earlier";
+            return err.str();
+        }
+    }
+
+    return "";
+}
+
+/**
+ * @brief Runs one kernel on one case and compares it with the reference
+ *
+ * @param k         The kernel
+ * @param c         The case
+ * @return string   An empty string if the kernel is right, otherwise the problem
+ */
+static string runCase(const Kernel& k, const Case& c)
+{
+    int rows = c.times.size();
+    int cols = c.times[0].size();
+
+    Matrix* jobs = makeJobs(c);
+    Permutation* perm = new Permutation(cols);
+    for (int j = 0; j < cols; ++j)
+        perm->addElement(c.order[j]);
+    perm->setCurSize(c.size);
+
+    // the kernel, on a matrix that may hold values of an earlier evaluation
+    Matrix* comp = new Matrix(rows, cols);
+    for (int r = 0; r < rows; ++r)
+        for (int j = 0; j < cols; ++j)
+            comp->setVal(c.dirty ? 1000003 * (r + 1) + j : 0, r, j);
+    int cmax = k.eval(jobs, comp, perm);
+
+    // the reference, on the jobs laid out in sequence order
+    Matrix* p   = new Matrix(rows, c.size);
+    Matrix* ref = new Matrix(rows, c.size);
+    for (int r = 0; r < rows; ++r)
+        for (int j = 0; j < c.size; ++j)
+            p->setVal(c.times[r][c.order[j]], r, j);
+    ref->clearMatrix();
+    int refCmax = fssType(p, ref, k.alg);
+
+    ostringstream err;
+    string rule = checkSchedule(k.alg, p, ref, c.size);
+    if (!rule.empty())
+        err << "the reference schedule is not valid: " << rule;
+    else if (cmax != refCmax)
+        err << "Cmax " << cmax << ", the reference gives " << refCmax;
+
+    for (int r = 0; r < rows && err.str().empty() && k.matrix; ++r)
+        for (int j = 0; j < c.size && err.str().empty(); ++j)
+            if (comp->getVal(r, j) != ref->getVal(r, j))
+                err << "completion time (" << r << "," << j << ") is " << comp->getVal(r, j) << ", the reference gives " << ref->getVal(r, j);
+
+    if (err.str().empty() && k.matrix)
+    {
+        rule = checkSchedule(k.alg, p, comp, c.size);
+        if (!rule.empty())
+            err << "the schedule is not valid: " << rule;
+    }
+
+    delete ref;
+    delete p;
+    delete comp;
+    delete perm;
+    delete jobs;
+
+    return err.str();
+}
+
+/**
+ * @brief Removes a job from a case, from the instance and the sequence
+ *
+ * @param c     The case
+ * @param job   The job (column) to remove
+ * @return Case The smaller case
+ */
+static Case dropJob(const Case& c, const int job)
+{
+    Case smaller = c;
+    for (size_t r = 0; r < smaller.times.size(); ++r)
+        smaller.times[r].erase(smaller.times[r].begin() + job);
+
+    smaller.order.clear();
+    for (size_t j = 0; j < c.order.size(); ++j)
+    {
+        if (c.order[j] == job)
+        {
+            if ((int)j < c.size) --smaller.size;
+            continue;
+        }
+        smaller.order.push_back(c.order[j] - (c.order[j] > job));
+    }
+
+    return smaller;
+}
+
+/**
+ * @brief Shrinks a failing case: removes jobs and machines, makes the
+ *          processing times smaller, and starts from a clean matrix, for as
+ *          long as the kernel still fails
+ *
+ * @param k     The kernel
+ * @param c     The failing case
+ * @return Case The smallest failing case found
+ */
+static Case shrink(const Kernel& k, Case c)
+{
+    int minRows = (k.alg == 2) ? 2 : 1;
+    bool smaller = true;
+
+    while (smaller)
+    {
+        smaller = false;
+
+        // jobs, from the end of the sequence
+        for (int j = (int)c.order.size() - 1; j >= 0 && c.order.size() > 1; --j)
+        {
+            if (j >= (int)c.order.size())
+                continue;
+
+            Case next = dropJob(c, c.order[j]);
+            if (next.size >= 1 && !runCase(k, next).empty())
+            {
+                c = next;
+                smaller = true;
+            }
+        }
+
+        // machines
+        for (int r = (int)c.times.size() - 1; r >= 0 && (int)c.times.size() > minRows; --r)
+        {
+            Case next = c;
+            next.times.erase(next.times.begin() + r);
+            if (!runCase(k, next).empty())
+            {
+                c = next;
+                smaller = true;
+            }
+        }
+
+        // processing times, to 1 or else to half
+        for (size_t r = 0; r < c.times.size(); ++r)
+        {
+            for (size_t j = 0; j < c.times[r].size(); ++j)
+            {
+                if (c.times[r][j] <= 1)
+                    continue;
+
+                Case next = c;
+                next.times[r][j] = 1;
+                if (runCase(k, next).empty())
+                    next.times[r][j] = c.times[r][j] / 2;
+                if (!runCase(k, next).empty())
+                {
+                    c = next;
+                    smaller = true;
+                }
+            }
+        }
+
+        // a clean matrix
+        if (c.dirty)
+        {
+            Case next = c;
+            next.dirty = false;
+            if (!runCase(k, next).empty())
+            {
+                c = next;
+                smaller = true;
+            }
+        }
+    }
+
+    return c;
+}
+
+/**
+ * @brief Prints a failing case and writes its instance in the DataFiles
+ *          format to results/diffcheck/<kernel>.txt
+ *
+ * @param k     The kernel
+ * @param c     The case
+ */
+static void report(const Kernel& k, const Case& c)
+{
+    int rows = c.times.size();
+    int cols = c.times[0].size();
+
+    cout << "  " << rows << " machine(s), " << cols << " job(s), the first " << c.size << " evaluated";
+    cout << (c.dirty ? ", on a matrix that was not cleared" : "") << ": " << runCase(k, c) << "\n";
+
+    cout << "  sequence:";
+    for (size_t j = 0; j < c.order.size(); ++j)
+        cout << " " << c.order[j] + 1;
+    cout << "\n  processing times:\n";
+
+    OutputBuffer out;
+    out.putInt(rows); out.putChar(' '); out.putInt(cols); out.putString("\r\n");
+    for (int r = 0; r < rows; ++r)
+    {
+        cout << "   ";
+        for (int j = 0; j < cols; ++j)
+        {
+            cout << " " << c.times[r][j];
+            out.putInt(c.times[r][j]);
+            out.putChar(' ');
+        }
+        cout << "\n";
+        out.putString("\r\n");
+    }
+
+    mkdir("results", 0755);
+    mkdir("results/diffcheck", 0755);
+    string path = "results/diffcheck/" + k.name + ".txt";
+    if (out.writeFile(path.c_str()))
+        cout << "  written to " << path << "\n";
+}
+
+/**
+ * @brief Checks that NEH and decomposition return every job once, with the
+ *          Cmax the reference gives for their sequence
+ *
+ * @param c         The case (its instance is used)
+ * @param tp        The thread pool decomposition shares its blocks with
+ * @param mt        Picks the block size
+ * @return string   An empty string if both are right, otherwise the problem
+ */
+static string checkSolvers(const Case& c, ThreadPool* tp, mt19937& mt)
+{
+    Matrix* jobs = makeJobs(c);
+    int cols = jobs->getCols();
+    ostringstream err;
+
+    for (int solver = 0; solver < 2 && err.str().empty(); ++solver)
+    {
+        vector<int> sequence;
+        int cmax;
+        Memory mem;
+
+        if (solver == 0)
+        {
+            Permutation* perm = new Permutation(cols);
+            Matrix* comp = new Matrix(jobs->getRows(), cols);
+            initialize(jobs, perm);
+            cmax = neh(jobs, comp, perm, &mem, c.alg);
+            sequence.assign(perm->getBest(), perm->getBest() + cols);
+            delete comp;
+            delete perm;
+        }
+        else
+        {
+            int blockSize = uniform_int_distribution<int>(1, max(1, cols))(mt);
+            cmax = decompose(jobs, &mem, c.alg, tp, blockSize, mt() % 3, mt() % 4, sequence);
+        }
+
+        vector<int> sorted(sequence);
+        sort(sorted.begin(), sorted.end());
+        bool permutation = (int)sorted.size() == cols;
+        for (int j = 0; j < cols && permutation; ++j)
+            permutation = sorted[j] == j;
+
+        if (!permutation)
+            err << (solver == 0 ? "neh" : "decompose") << " did not return every job once";
+        else if (cmax != evalSequence(jobs, c.alg, sequence, 0, cols))
+            err << (solver == 0 ? "neh" : "decompose") << " returned Cmax " << cmax << ", its sequence gives "
+                << evalSequence(jobs, c.alg, sequence, 0, cols);
+    }
+
+    delete jobs;
+    return err.str();
+}
+
+int main(int argc, char** argv)
+{
+    int cases       = (argc > 1) ? atoi(argv[1]) : 2000;
+    unsigned seed   = (argc > 2) ? strtoul(argv[2], nullptr, 10) : random_device()();
+    int maxMachines = (argc > 3) ? atoi(argv[3]) : 12;
+    int maxJobs     = (argc > 4) ? atoi(argv[4]) : 40;
+
+    if (cases < 1 || maxMachines < 1 || maxJobs < 1)
+    {
+        cout << "usage: diffcheck.out [cases] [seed] [maxMachines] [maxJobs]\n";
+        return 1;
+    }
+
+    ThreadPool tp(max(2u, thread::hardware_concurrency()));
+
+    // every kernel, the wavefronts with tiles small enough to cross many edges
+    vector<Kernel> kernels;
+    kernels.push_back({ "fssPerm",   1, true, fssPerm });
+    kernels.push_back({ "fssbPerm",  2, true, fssbPerm });
+    kernels.push_back({ "fssnwPerm", 3, true, fssnwPerm });
+    kernels.push_back({ "fssWavefront", 1, true,
+        [&tp](Matrix* jobs, Matrix* comp, Permutation* perm) { return fssWavefront(jobs, comp, perm, &tp, 3, 4); } });
+    kernels.push_back({ "fssbWavefront", 2, true,
+        [&tp](Matrix* jobs, Matrix* comp, Permutation* perm) { return fssbWavefront(jobs, comp, perm, &tp, 2, 5); } });
+    for (int alg = 1; alg <= 3; ++alg)
+    {
+        kernels.push_back({ string("evalSequence-") + ALG_NAMES[alg], alg, false,
+            [alg](Matrix* jobs, Matrix*, Permutation* perm) {
+                vector<int> sequence(perm->getPerm(), perm->getPerm() + perm->getCurSize());
+                return evalSequence(jobs, alg, sequence, 0, sequence.size());
+            } });
+    }
+
+    cout << "Checking " << kernels.size() << " kernel(s) on " << cases << " case(s), seed " << seed << "\n";
+
+    mt19937 mt(seed);
+    vector<long> checked(kernels.size(), 0);
+    vector<bool> failed(kernels.size(), false);
+    long solverChecks = 0;
+    bool solverFailed = false;
+
+    for (int n = 0; n < cases; ++n)
+    {
+        // a random instance, sequence, and prefix
+        Case c;
+        int rows = uniform_int_distribution<int>(1, maxMachines)(mt);
+        int cols = uniform_int_distribution<int>(1, maxJobs)(mt);
+        int dist = mt() % 3;
+
+        Generator gen(rows, cols, 1 + mt() % 2147483646, dist);
+        c.times.assign(rows, vector<int>(cols));
+        for (int r = 0; r < rows; ++r)
+            gen.nextRow(c.times[r].data());
+
+        c.order.resize(cols);
+        for (int j = 0; j < cols; ++j)
+            c.order[j] = j;
+        shuffle(c.order.begin(), c.order.end(), mt);
+
+        c.size  = (mt() % 2) ? cols : uniform_int_distribution<int>(1, cols)(mt);
+        c.dirty = mt() % 2;
+
+        for (size_t k = 0; k < kernels.size(); ++k)
+        {
+            // blocking needs a machine after the first, the reference reads it
+            if (failed[k] || (kernels[k].alg == 2 && rows < 2))
+                continue;
+
+            c.alg = kernels[k].alg;
+            ++checked[k];
+
+            string problem = runCase(kernels[k], c);
+            if (problem.empty())
+                continue;
+
+            failed[k] = true;
+            cout << kernels[k].name << " (" << ALG_NAMES[c.alg] << ") FAILED: " << problem << "\n";
+            cout << " shrunk to:\n";
+            report(kernels[k], shrink(kernels[k], c));
+        }
+
+        // the solvers, on smaller instances since NEH is quadratic
+        if (!solverFailed && cols <= 20 && (rows >= 2 || n % 3 != 1))
+        {
+            c.alg = 1 + n % 3;
+            ++solverChecks;
+
+            string problem = checkSolvers(c, &tp, mt);
+            if (!problem.empty())
+            {
+                solverFailed = true;
+                cout << ALG_NAMES[c.alg] << " solver FAILED on " << rows << " x " << cols << ": " << problem << "\n";
+            }
+        }
+    }
+
+    // the tally
+    int failures = solverFailed;
+    for (size_t k = 0; k < kernels.size(); ++k)
+    {
+        cout << "  " << kernels[k].name << ": " << checked[k] << " case(s), " << (failed[k] ? "FAILED" : "ok") << "\n";
+        failures += failed[k];
+    }
+    cout << "  neh/decompose: " << solverChecks << " case(s), " << (solverFailed ? "FAILED" : "ok") << "\n";
+
+    cout << (failures == 0 ? "Every kernel matches the reference\n" : "Some kernels do not match the reference\n");
+    return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,82 @@
+/**
+ * @file gantt.cpp
+ * @author Matthew Harker
+ * @brief Reads a binary Gantt file through the zero copy reader in Gantt.h.
+ *          Prints a summary of the schedule and checks it (no job starts
+ *          before it ends on the machine above, no two jobs overlap on a
+ *          machine), or with "csv" prints it in the Gantt CSV format.
+ *
+ *          usage: gantt.out <file> [csv]
+ * @version 1.0
+ * @date 2019-06-10
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+#include <iostream>
+#include <string>
+
+#include "Gantt.h"
+
+using namespace std;
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        cout << "usage: gantt.out <file> [csv]\n";
+        return 1;
+    }
+
+    GanttView view;
+    if (!view.open(argv[1]))
+    {
+        cout << argv[1] << " is not a binary Gantt file\n";
+        return 1;
+    }
+
+    int rows = view.getRows();
+    int cols = view.getCols();
+
+    // print it the way the Gantt CSV would have
+    if (argc > 2 && string(argv[2]) == "csv")
+    {
+        cout << "Item,Machine,Job,Start,End\n";
+        int item = 0;
+        for (int r = 0; r < rows; ++r)
+            for (int c = 0; c < cols; ++c)
+                cout << ++item << ",Machine " << r + 1 << ",Job " << c + 1 << ","
+                     << view.getStart(r)[c] << "," << view.getEnd(r)[c] << "\n";
+        return 0;
+    }
+
+    // a job can't start before it is done on the machine above, or before
+    // the job ahead of it is done on the same machine
+    long problems = 0;
+    for (int r = 0; r < rows; ++r)
+    {
+        const int* start = view.getStart(r);
+        const int* end   = view.getEnd(r);
+
+        for (int c = 0; c < cols; ++c)
+        {
+            if (end[c] < start[c]) ++problems;
+            if (c > 0 && start[c] < view.getEnd(r)[c - 1]) ++problems;
+            if (r > 0 && start[c] < view.getEnd(r - 1)[c]) ++problems;
+        }
+    }
+
+    const char* names[] = { "?", "FSS", "FSSB", "FSSNW" };
+    int alg = (view.getAlg() >= 1 && view.getAlg() <= 3) ? view.getAlg() : 0;
+
+    cout << "Datafile " << view.getDatafile() << " (" << names[alg] << "), " << rows << " machine(s) x ";
+    cout << cols << " job(s), Cmax " << view.getCmax() << "\n";
+    cout << "Last end time: " << view.getEnd(rows - 1)[cols - 1] << "\n";
+    cout << "Sequence starts:";
+    for (int c = 0; c < cols && c < 10; ++c)
+        cout << " " << view.getSequence()[c] + 1;
+    cout << ((cols > 10) ? " ...\n" : "\n");
+    cout << ((problems == 0) ? "Schedule is consistent\n" : to_string(problems) + " problem(s) in the schedule\n");
+
+    return (problems == 0) ? 0 : 1;
+}
@@ -0,0 +1,142 @@
+/**
+ * @file generate.cpp
+ * @author Matthew Harker
+ * @brief Makes flowshop instances with Taillard's generator. Either makes
+ *          Taillard instances again from their seeds (and checks them against
+ *          DataFiles), or makes one instance of any size and distribution,
+ *          in the text format or the binary format (.bin).
+ *
+ *          usage: generate.out taillard [first] [last] [dir] [txt|bin]
+ *                 generate.out <machines> <jobs> <seed> <output> [uniform|correlated|heavy]
+ * @version 1.0
+ * @date 2019-06-16
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <sys/stat.h>
+
+#include "Generator.h"
+
+using namespace std;
+
+/**
+ * @brief Returns the size of a file
+ *
+ * @param pathname  The file
+ * @return double   Its size in MB, or 0 if it cannot be found
+ */
+static double fileMB(const string pathname)
+{
+    struct stat info;
+    return (stat(pathname.c_str(), &info) == 0) ? info.st_size / (1024.0 * 1024.0) : 0;
+}
+
+/**
+ * @brief Returns whether two files hold exactly the same bytes
+ *
+ * @param a     The first file
+ * @param b     The second file
+ * @return true If both can be read and are the same
+ */
+static bool sameFile(const string a, const string b)
+{
+    ifstream fa(a, ios::binary), fb(b, ios::binary);
+    if (!fa.is_open() || !fb.is_open())
+        return false;
+
+    return equal(istreambuf_iterator<char>(fa), istreambuf_iterator<char>(), istreambuf_iterator<char>(fb)) &&
+           fb.peek() == EOF;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc > 1 && string(argv[1]) == "taillard")
+    {
+        int first     = (argc > 2) ? atoi(argv[2]) : 1;
+        int last      = (argc > 3) ? atoi(argv[3]) : 120;
+        string dir    = (argc > 4) ? argv[4] : "generated";
+        bool binary   = (argc > 5) && string(argv[5]) == "bin";
+
+        mkdir(dir.c_str(), 0755);
+
+        int made = 0, matched = 0;
+        for (int d = first; d <= last; ++d)
+        {
+            int32_t seed;
+            int rows, cols;
+            if (!taillardInstance(d, seed, rows, cols))
+            {
+                cout << "There is no Taillard instance " << d << " (1 to 120)\n";
+                return 1;
+            }
+
+            string path = dir + "/" + to_string(d) + (binary ? ".bin" : ".txt");
+            if (!writeGenerated(path, rows, cols, seed, DIST_UNIFORM, binary))
+            {
+                cout << "Could not write " << path << "\n";
+                return 1;
+            }
+            ++made;
+
+            // a text instance must be the very same file as the datafile
+            if (!binary)
+            {
+                string datafile = "DataFiles/" + to_string(d) + ".txt";
+                if (sameFile(path, datafile))
+                    ++matched;
+                else
+                    cout << path << " does not match " << datafile << "\n";
+            }
+        }
+
+        cout << "Made " << made << " Taillard instance(s) in " << dir;
+        if (!binary)
+            cout << ", " << matched << " match their datafile";
+        cout << "\n";
+        return (binary || matched == made) ? 0 : 1;
+    }
+
+    if (argc < 5)
+    {
+        cout << "usage: generate.out taillard [first] [last] [dir] [txt|bin]\n";
+        cout << "       generate.out <machines> <jobs> <seed> <output> [uniform|correlated|heavy]\n";
+        return 1;
+    }
+
+    int rows      = atoi(argv[1]);
+    int cols      = atoi(argv[2]);
+    int32_t seed  = atol(argv[3]);
+    string output = argv[4];
+    int dist      = parseDistribution((argc > 5) ? argv[5] : "uniform");
+    bool binary   = output.size() > 4 && output.compare(output.size() - 4, 4, ".bin") == 0;
+
+    if (dist < 0)
+    {
+        cout << "The distribution must be uniform, correlated, or heavy\n";
+        return 1;
+    }
+    if (seed < 1 || seed == INT32_MAX)
+    {
+        cout << "The seed must be from 1 to 2147483646\n";
+        return 1;
+    }
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    if (!writeGenerated(output, rows, cols, seed, dist, binary))
+    {
+        cout << "Could not write " << output << "\n";
+        return 1;
+    }
+    double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    cout << "Wrote " << rows << " x " << cols << " (" << (binary ? "binary" : "text") << ") to " << output;
+    cout << ": " << fileMB(output) << " MB in " << ms << " ms (" << fileMB(output) / (ms / 1000) << " MB/s)\n";
+    return 0;
+}
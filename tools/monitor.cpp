@@ -0,0 +1,73 @@
+/**
+ * @file monitor.cpp
+ * @author Matthew Harker
+ * @brief Follows the results a batch publishes into shared memory (see the
+ *          publish option) through the reader in Ring.h, printing one line
+ *          per result as it finishes. Starts with the results still in the
+ *          ring unless "new" is given, and stops after a number of seconds
+ *          without a new result.
+ *
+ *          usage: monitor.out [name] [idleSeconds] [new]
+ * @version 1.0
+ * @date 2019-06-13
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "Ring.h"
+
+using namespace std;
+
+int main(int argc, char** argv)
+{
+    string name = (argc > 1) ? argv[1] : "/flowshop";
+    int idle    = (argc > 2) ? atoi(argv[2]) : 10;
+    bool onlyNew = (argc > 3) && string(argv[3]) == "new";
+
+    // the batch may not have created the ring yet
+    RingReader reader;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    while (!reader.open(name, !onlyNew))
+    {
+        if (chrono::steady_clock::now() - start >= chrono::seconds(idle))
+        {
+            cout << "No results are being published to " << name << "\n";
+            return 1;
+        }
+        this_thread::sleep_for(chrono::milliseconds(10));
+    }
+
+    const char* names[] = { "?", "FSS", "FSSB", "FSSNW" };
+    RingRecord rec;
+    long seen = 0;
+
+    chrono::steady_clock::time_point last = chrono::steady_clock::now();
+    while (chrono::steady_clock::now() - last < chrono::seconds(idle))
+    {
+        if (!reader.next(&rec))
+        {
+            // nothing new, check again shortly
+            this_thread::sleep_for(chrono::microseconds(200));
+            continue;
+        }
+
+        int alg = (rec.alg >= 1 && rec.alg <= 3) ? rec.alg : 0;
+        cout << rec.datafile << " " << names[alg] << " Cmax " << rec.cmax << " (original " << rec.originalCmax;
+        cout << "), " << rec.funcCalls << " calls, " << rec.timeTaken << " ms, sequence";
+        for (uint32_t i = 0; i < rec.stored && i < 5; ++i)
+            cout << " " << rec.sequence[i] + 1;
+        cout << ((rec.jobs > 5) ? " ...\n" : "\n");
+
+        ++seen;
+        last = chrono::steady_clock::now();
+    }
+
+    cout << seen << " result(s) seen, " << reader.getLost() << " missed\n";
+    return 0;
+}
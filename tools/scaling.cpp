@@ -0,0 +1,251 @@
+/**
+ * @file scaling.cpp
+ * @author Matthew Harker
+ * @brief Measures how the batch solver scales with threads and with the size
+ *          of the instances. For every size, a batch of synthetic instances
+ *          is run through flowshop() for FSS, FSSB, and FSSNW on a thread
+ *          pool of each thread count, from 1 to the number of hardware
+ *          threads, the way the program runs a batch: a Batch with its
+ *          result writer and instance loader, and a barrier after each
+ *          algorithm. The speedup over one thread, the parallel efficiency,
+ *          and the throughput are written as a CSV table. The instances are
+ *          made with the Taillard generator and packed into a bundle, so no
+ *          datafiles are needed. The options file is not read, every option
+ *          keeps its default.
+ *
+ *          usage: scaling.out [instances] [sizes] [repeats] [output] [maxThreads]
+ *              sizes: jobs x machines, separated by commas, such as
+ *                     20x5,50x10,100x20
+ * @version 1.0
+ * @date 2019-06-22
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "Batch.h"
+#include "Bundle.h"
+#include "flowshop.h"
+#include "Generator.h"
+#include "ThreadPool.h"
+
+using namespace std;
+
+// one cell of the grid
+struct Cell {
+    int    threads;     // the workers of the pool
+    int    jobs;        // the jobs of every instance
+    int    machines;    // the machines of every instance
+    int    instances;   // how many instances the batch solved (per algorithm)
+    double wall;        // the fastest batch (ms)
+    double algWall[3];  // the time of each algorithm in that batch (ms)
+    long   evals;       // the evaluations of one batch
+};
+
+// the instances are packed into this bundle while the tool runs
+const string SCALING_BUNDLE = "results/scaling.bundle";
+
+/**
+ * @brief Runs every instance through each algorithm on a pool of some size,
+ *          as runFlowshop() does
+ *
+ * @param bundle    The bundle the instances are in
+ * @param ids       The numbers of the instances in the bundle
+ * @param threads   The workers of the pool
+ * @param algWall   Receives the time of each algorithm (ms)
+ * @param evals     Receives the evaluations of the batch
+ * @return double   The wall time of the batch (ms), from the first task
+ *                      queued to the last result written
+ */
+static double runBatch(Bundle* bundle, const vector<int>& ids, const int threads, double* algWall, long& evals)
+{
+    ThreadPool tp(threads);
+    ResultWriter writer(2 * threads, nullptr, nullptr, bundle);
+
+    // the loader reads ahead in the order the tasks are queued
+    vector<int> order;
+    for (int alg = 1; alg <= 3; ++alg)
+        order.insert(order.end(), ids.begin(), ids.end());
+    InstanceLoader loader(order, bundle, (size_t)64 << 20, false);
+
+    Batch batch;
+    batch.pool       = &tp;
+    batch.writer     = &writer;
+    batch.bundle     = bundle;
+    batch.loader     = &loader;
+    batch.cache      = nullptr;
+    batch.counting   = false;
+    batch.accounting = false;
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (int alg = 1; alg <= 3; ++alg)
+    {
+        chrono::steady_clock::time_point algStart = chrono::steady_clock::now();
+
+        vector< future<int> > futures;
+        for (size_t i = 0; i < ids.size(); ++i)
+            futures.emplace_back(tp.enqueue(&flowshop, ids[i], alg, &batch));
+
+        // every task of an algorithm finishes before the next one starts
+        for (size_t f = 0; f < futures.size(); ++f)
+            futures[f].get();
+
+        algWall[alg - 1] = chrono::duration<double, milli>(chrono::steady_clock::now() - algStart).count();
+    }
+
+    writer.finish();
+    double wall = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    loader.finish();
+    evals = writer.getTotals()->getFuncCalls();
+    return wall;
+}
+
+/**
+ * @brief Reads the list of sizes
+ *
+ * @param list      Sizes such as 20x5,50x10 (jobs x machines)
+ * @param sizes     Receives the (jobs, machines) pairs
+ * @return true     If every size could be read
+ */
+static bool parseSizes(const string list, vector< pair<int, int> >& sizes)
+{
+    stringstream ss(list);
+    string size;
+    while (getline(ss, size, ','))
+    {
+        size_t x = size.find('x');
+        if (x == string::npos)
+            return false;
+
+        int jobs = atoi(size.substr(0, x).c_str());
+        int machines = atoi(size.substr(x + 1).c_str());
+        if (jobs < 1 || machines < 1)
+            return false;
+
+        sizes.push_back(make_pair(jobs, machines));
+    }
+
+    return !sizes.empty();
+}
+
+int main(int argc, char** argv)
+{
+    int maxThreads = (argc > 5) ? atoi(argv[5]) : max(1u, thread::hardware_concurrency());
+    int count      = (argc > 1) ? atoi(argv[1]) : 4 * maxThreads;
+    string list    = (argc > 2) ? argv[2] : "20x5,50x10,100x20,200x20";
+    int repeats    = (argc > 3) ? atoi(argv[3]) : 3;
+    string output  = (argc > 4) ? argv[4] : "results/scaling.csv";
+
+    vector< pair<int, int> > sizes;
+    if (count < 1 || repeats < 1 || maxThreads < 1 || !parseSizes(list, sizes))
+    {
+        cout << "usage: scaling.out [instances] [sizes] [repeats] [output] [maxThreads]\n";
+        cout << "    sizes: jobs x machines, separated by commas, such as 20x5,50x10,100x20\n";
+        return 1;
+    }
+
+    // every thread count up to maxThreads (the hardware threads by default)
+    vector<int> threadCounts;
+    for (int t = 1; t <= maxThreads; ++t)
+        threadCounts.push_back(t);
+
+    // every instance is made once and packed into a bundle, numbered by
+    // size, so the tasks find them the way they find datafiles
+    vector< vector<int> > ids(sizes.size());
+    vector<int> allIds;
+    vector<Matrix*> instances;
+    for (size_t s = 0; s < sizes.size(); ++s)
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            Generator gen(sizes[s].second, sizes[s].first, 1 + i + 1000 * s, DIST_UNIFORM);
+            instances.push_back(gen.makeMatrix());
+            ids[s].push_back(1 + i + 1000000 * s);
+            allIds.push_back(ids[s].back());
+        }
+    }
+
+    mkdir("results", 0755);
+    bool packed = writeBundle(SCALING_BUNDLE, allIds, instances, vector<string>());
+    for (size_t i = 0; i < instances.size(); ++i)
+        delete instances[i];
+
+    Bundle bundle;
+    if (!packed || !bundle.open(SCALING_BUNDLE))
+    {
+        cout << "Could not write the instances to " << SCALING_BUNDLE << "\n";
+        return 1;
+    }
+
+    cout << "Solving " << count << " instance(s) of " << sizes.size() << " size(s) with FSS, FSSB, and FSSNW on 1 to ";
+    cout << maxThreads << " thread(s), the fastest of " << repeats << " batch(es) each\n";
+
+    vector<Cell> cells;
+    for (size_t s = 0; s < sizes.size(); ++s)
+    {
+        for (size_t t = 0; t < threadCounts.size(); ++t)
+        {
+            Cell cell;
+            cell.threads   = threadCounts[t];
+            cell.jobs      = sizes[s].first;
+            cell.machines  = sizes[s].second;
+            cell.instances = count;
+            cell.wall      = 0;
+
+            for (int r = 0; r < repeats; ++r)
+            {
+                double algWall[3];
+                double wall = runBatch(&bundle, ids[s], cell.threads, algWall, cell.evals);
+                if (r == 0 || wall < cell.wall)
+                {
+                    cell.wall = wall;
+                    copy(algWall, algWall + 3, cell.algWall);
+                }
+            }
+
+            cells.push_back(cell);
+            cout << "  " << cell.jobs << "x" << cell.machines << " on " << cell.threads << " thread(s): ";
+            cout << cell.wall << " ms\n";
+        }
+    }
+
+    // the mapping stays valid until the bundle is closed
+    unlink(SCALING_BUNDLE.c_str());
+
+    // the table, each size compared with its own one thread batch
+    ofstream file(output);
+    if (!file.is_open())
+    {
+        cout << "Could not write " << output << "\n";
+        return 1;
+    }
+
+    file << "jobs,machines,instances,threads,wall_ms,fss_ms,fssb_ms,fssnw_ms,speedup,efficiency,tasks_per_s,evaluations_per_s\n";
+    for (size_t c = 0; c < cells.size(); ++c)
+    {
+        const Cell& cell = cells[c];
+        double base = cells[c - (cell.threads - 1)].wall;
+        double speedup = base / cell.wall;
+
+        file << cell.jobs << "," << cell.machines << "," << cell.instances << "," << cell.threads << ",";
+        file << cell.wall << "," << cell.algWall[0] << "," << cell.algWall[1] << "," << cell.algWall[2] << ",";
+        file << speedup << "," << speedup / cell.threads << ",";
+        file << 3 * cell.instances / (cell.wall / 1000) << "," << cell.evals / (cell.wall / 1000) << "\n";
+    }
+
+    cout << "Results in " << output << "\n";
+    return 0;
+}
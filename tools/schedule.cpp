@@ -0,0 +1,162 @@
+/**
+ * @file schedule.cpp
+ * @author Matthew Harker
+ * @brief Rebuilds the full schedule of one result from the summary table.
+ *          Below the full output level the completion times are never
+ *          written; with output set to schedule the summary keeps each job
+ *          sequence, and this tool reads it back, re-evaluates it on the
+ *          instance, checks the makespan, and writes the rawData and Gantt
+ *          files as the full level would have. With "print" it also prints
+ *          the completion times.
+ *
+ *          usage: schedule.out <datafile> <alg> [summary] [print]
+ * @version 1.0
+ * @date 2019-06-11
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "Bundle.h"
+#include "flowshop.h"
+#include "Options.h"
+#include "OutputBuffer.h"
+
+using namespace std;
+
+/**
+ * @brief Splits one line of the summary table into its fields
+ *
+ * @param line              The line
+ * @return vector<string>   The fields
+ */
+static vector<string> splitRow(const string line)
+{
+    vector<string> fields;
+    istringstream iss(line);
+    string field;
+
+    while (getline(iss, field, ','))
+        fields.push_back(field);
+
+    return fields;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        cout << "usage: schedule.out <datafile> <alg> [summary] [print]\n";
+        return 1;
+    }
+
+    // the bundle and gantt options apply here too
+    getOptions()->load("parameters/options.txt");
+
+    int datafile  = atoi(argv[1]);
+    int alg       = atoi(argv[2]);
+    string path   = (argc > 3) ? argv[3] : getOptions()->getString("summary", "results/summary.csv");
+    bool print    = (argc > 4) && string(argv[4]) == "print";
+
+    const char* names[] = { "", "FSS", "FSSB", "FSSNW" };
+    if (alg < 1 || alg > 3)
+    {
+        cout << "The algorithm must be 1 (FSS), 2 (FSSB), or 3 (FSSNW)\n";
+        return 1;
+    }
+
+    ifstream file(path);
+    string line;
+    if (!file.is_open() || !getline(file, line) || line.find(",sequence") == string::npos)
+    {
+        cout << path << " is not a summary table with sequences (run with output set to schedule)\n";
+        return 1;
+    }
+
+    // the sequence is the last column, wherever that is
+    size_t columns = splitRow(line).size();
+
+    // the last row of the datafile and algorithm wins
+    vector<string> row;
+    while (getline(file, line))
+    {
+        vector<string> fields = splitRow(line);
+        if (fields.size() == columns && atoi(fields[0].c_str()) == datafile && fields[1] == names[alg])
+            row = fields;
+    }
+
+    if (row.empty())
+    {
+        cout << "Datafile " << datafile << " (" << names[alg] << ") is not in " << path << "\n";
+        return 1;
+    }
+
+    // load the instance the same way the batch does
+    Bundle bundle;
+    Matrix* jobs = openBundle(&bundle) ? bundle.getMatrix(datafile) : nullptr;
+    if (jobs == nullptr)
+        jobs = new Matrix(datafile);
+
+    // rebuild the sequence (the table numbers jobs from 1)
+    Permutation* perm = new Permutation(jobs->getCols());
+    istringstream seq(row.back());
+    int job, count = 0;
+    while (seq >> job && count < jobs->getCols())
+    {
+        perm->addElement(job - 1);
+        ++count;
+    }
+
+    if (count != jobs->getCols())
+    {
+        cout << "The sequence has " << count << " job(s), datafile " << datafile << " has " << jobs->getCols() << "\n";
+        return 1;
+    }
+    perm->setCurrentToBest();
+
+    // evaluate it, the makespan must be the one in the table
+    Matrix* comp = new Matrix(jobs->getRows(), jobs->getCols());
+    int cmax = fssTypePerm(jobs, comp, perm, alg);
+    perm->setBestVal(cmax);
+
+    if (cmax != atoi(row[3].c_str()))
+    {
+        cout << "Rebuilt Cmax " << cmax << " does not match " << row[3] << " in " << path << "\n";
+        return 1;
+    }
+
+    // write the files the full output level would have
+    Memory mem;
+    mem.addFuncCalls(atoi(row[5].c_str()));
+    mem.setTimeTaken(atof(row[6].c_str()));
+    mem.setOriginalCmax(atoi(row[4].c_str()));
+
+    OutputBuffer out;
+    mem.writeAllData(jobs, comp, perm, alg, datafile,
+                     parseGanttFormat(getOptions()->getString("gantt", "csv")), &out);
+
+    cout << "Datafile " << datafile << " (" << names[alg] << "): Cmax " << cmax << ", rawData and Gantt files written\n";
+
+    if (print)
+    {
+        for (int r = 0; r < comp->getRows(); ++r)
+        {
+            cout << comp->getVal(r, 0);
+            for (int c = 1; c < comp->getCols(); ++c)
+                cout << "," << comp->getVal(r, c);
+            cout << "\n";
+        }
+    }
+
+    delete comp;
+    delete perm;
+    delete jobs;
+
+    return 0;
+}
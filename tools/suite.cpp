@@ -0,0 +1,308 @@
+/**
+ * @file suite.cpp
+ * @author Matthew Harker
+ * @brief Measures the quality of a solver against time on the Taillard
+ *          instances. Each instance is made from its seed, solved (FSS)
+ *          again and again with NEH's random tie breaking until the time
+ *          budget runs out, and the best makespan is compared with the best
+ *          known upper bound. The average relative percentage deviation
+ *          (ARPD), the time, and the evaluations of each class are printed,
+ *          and the result and the anytime curve (the best makespan over
+ *          time) of every instance are written as CSV.
+ *
+ *          usage: suite.out [set] [solver] [budgetMs] [output]
+ *              set:    all, a class such as 50x10 (jobs x machines), or a
+ *                      range of instances such as 1-30
+ *              solver: neh, or decompose:<jobs per block>
+ * @version 1.0
+ * @date 2019-06-21
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <sys/stat.h>
+#include <thread>
+#include <vector>
+
+#include "decompose.h"
+#include "flowshop.h"
+#include "Generator.h"
+#include "ThreadPool.h"
+
+using namespace std;
+
+// one improvement of the best makespan of an instance
+struct Point {
+    double time;        // ms since the instance started
+    long   evals;       // evaluations so far
+    int    cmax;        // the new best makespan
+};
+
+// the result of one instance
+struct Outcome {
+    int    number;      // the Taillard instance, 1 to 120
+    int    rows;        // the machines
+    int    cols;        // the jobs
+    int    upperBound;  // the best known makespan
+    int    runs;        // how many times the solver ran
+    double time;        // ms spent on the instance
+    long   evals;       // evaluations over every run
+    vector<Point> curve;
+};
+
+/**
+ * @brief Returns the relative percentage deviation of a makespan from the
+ *          upper bound
+ *
+ * @param cmax          The makespan
+ * @param upperBound    The best known makespan
+ * @return double       100 (cmax - upperBound) / upperBound
+ */
+static double rpd(const int cmax, const int upperBound)
+{
+    return 100.0 * (cmax - upperBound) / upperBound;
+}
+
+/**
+ * @brief Reads the set of instances to run
+ *
+ * @param name      all, a class such as 50x10, or a range such as 1-30
+ * @param numbers   Receives the instances
+ * @return true     If the name is known
+ */
+static bool selectSet(const string name, vector<int>& numbers)
+{
+    int32_t seed;
+    int rows, cols;
+
+    if (name == "all")
+    {
+        for (int n = 1; n <= 120; ++n)
+            numbers.push_back(n);
+        return true;
+    }
+
+    // a class of Taillard's, named jobs x machines
+    size_t x = name.find('x');
+    if (x != string::npos)
+    {
+        int jobs = atoi(name.substr(0, x).c_str());
+        int machines = atoi(name.substr(x + 1).c_str());
+        for (int n = 1; n <= 120; ++n)
+            if (taillardInstance(n, seed, rows, cols) && cols == jobs && rows == machines)
+                numbers.push_back(n);
+        return !numbers.empty();
+    }
+
+    // a range of instances, or a single one
+    size_t dash = name.find('-');
+    int first = atoi(name.substr(0, dash).c_str());
+    int last  = (dash == string::npos) ? first : atoi(name.substr(dash + 1).c_str());
+    for (int n = max(first, 1); n <= min(last, 120); ++n)
+        numbers.push_back(n);
+
+    return !numbers.empty();
+}
+
+/**
+ * @brief Solves an instance once with the solver
+ *
+ * @param jobs      The instance
+ * @param blockSize The jobs per block for decomposition, 0 for plain NEH
+ * @param tp        The workers decomposition solves blocks on
+ * @param evals     Adds the evaluations of the run
+ * @return int      The makespan found
+ */
+static int solveOnce(Matrix* jobs, const int blockSize, ThreadPool* tp, long& evals)
+{
+    Memory mem;
+    int cmax;
+
+    if (blockSize > 0 && blockSize < jobs->getCols())
+    {
+        vector<int> sequence;
+        cmax = decompose(jobs, &mem, 1, tp, blockSize, SPLIT_COST, 5, sequence);
+    }
+    else
+    {
+        Matrix* comp = new Matrix(jobs->getRows(), jobs->getCols());
+        Permutation* perm = new Permutation(jobs->getCols());
+        initialize(jobs, perm);
+        cmax = neh(jobs, comp, perm, &mem, 1);
+        delete perm;
+        delete comp;
+    }
+
+    evals += mem.getFuncCalls();
+    return cmax;
+}
+
+/**
+ * @brief Runs the solver on an instance until the budget runs out (at least
+ *          once), keeping every improvement of the best makespan
+ *
+ * @param number    The Taillard instance
+ * @param blockSize The jobs per block for decomposition, 0 for plain NEH
+ * @param budget    The time to spend on the instance (ms)
+ * @param tp        The workers decomposition solves blocks on
+ * @return Outcome  The result and its anytime curve
+ */
+static Outcome runInstance(const int number, const int blockSize, const double budget, ThreadPool* tp)
+{
+    Outcome out;
+    int32_t seed;
+    taillardInstance(number, seed, out.rows, out.cols);
+    out.number     = number;
+    out.upperBound = taillardUpperBound(number);
+    out.runs       = 0;
+    out.evals      = 0;
+
+    // made from its seed, the same as the datafile of the same number
+    Generator gen(out.rows, out.cols, seed, DIST_UNIFORM);
+    Matrix* jobs = gen.makeMatrix();
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    int best = -1;
+    do
+    {
+        int cmax = solveOnce(jobs, blockSize, tp, out.evals);
+        ++out.runs;
+
+        out.time = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        if (best < 0 || cmax < best)
+        {
+            best = cmax;
+            out.curve.push_back({ out.time, out.evals, cmax });
+        }
+    } while (out.time < budget);
+
+    delete jobs;
+    return out;
+}
+
+/**
+ * @brief Writes the result of every instance and their anytime curves
+ *
+ * @param dir       The directory to write into
+ * @param outcomes  The results
+ * @return true     If both files were written
+ */
+static bool writeResults(const string dir, const vector<Outcome>& outcomes)
+{
+    ofstream table(dir + "/instances.csv");
+    ofstream curves(dir + "/curves.csv");
+    if (!table.is_open() || !curves.is_open())
+        return false;
+
+    table << "instance,jobs,machines,upper_bound,first_cmax,first_ms,best_cmax,rpd,time_ms,evaluations,runs\n";
+    curves << "instance,time_ms,evaluations,cmax,rpd\n";
+
+    for (size_t i = 0; i < outcomes.size(); ++i)
+    {
+        const Outcome& o = outcomes[i];
+        const Point& first = o.curve.front();
+        const Point& last  = o.curve.back();
+
+        table << o.number << "," << o.cols << "," << o.rows << "," << o.upperBound << ",";
+        table << first.cmax << "," << first.time << "," << last.cmax << "," << rpd(last.cmax, o.upperBound) << ",";
+        table << o.time << "," << o.evals << "," << o.runs << "\n";
+
+        for (size_t p = 0; p < o.curve.size(); ++p)
+        {
+            curves << o.number << "," << o.curve[p].time << "," << o.curve[p].evals << ",";
+            curves << o.curve[p].cmax << "," << rpd(o.curve[p].cmax, o.upperBound) << "\n";
+        }
+    }
+
+    return table.good() && curves.good();
+}
+
+int main(int argc, char** argv)
+{
+    string set    = (argc > 1) ? argv[1] : "all";
+    string solver = (argc > 2) ? argv[2] : "neh";
+    double budget = (argc > 3) ? atof(argv[3]) : 0;
+    string output = (argc > 4) ? argv[4] : "results/suite";
+
+    // the solver is plain NEH, or decomposition into blocks of some size
+    int blockSize = 0;
+    if (solver.compare(0, 10, "decompose:") == 0)
+        blockSize = atoi(solver.substr(10).c_str());
+
+    vector<int> numbers;
+    if ((solver != "neh" && blockSize <= 0) || budget < 0 || !selectSet(set, numbers))
+    {
+        cout << "usage: suite.out [set] [solver] [budgetMs] [output]\n";
+        cout << "    set:    all, a class such as 50x10 (jobs x machines), or a range such as 1-30\n";
+        cout << "    solver: neh, or decompose:<jobs per block>\n";
+        return 1;
+    }
+
+    ThreadPool tp(max(1u, thread::hardware_concurrency()));
+
+    cout << "Solving " << numbers.size() << " Taillard instance(s) (FSS) with " << solver;
+    cout << ", " << budget << " ms each\n";
+
+    vector<Outcome> outcomes;
+    bool belowBound = false;
+    for (size_t i = 0; i < numbers.size(); ++i)
+    {
+        outcomes.push_back(runInstance(numbers[i], blockSize, budget, &tp));
+
+        // no heuristic should beat the best known makespan, if one does the
+        // instance or the evaluation is wrong
+        const Outcome& o = outcomes.back();
+        if (o.curve.back().cmax < o.upperBound)
+        {
+            cout << "ta" << o.number << ": Cmax " << o.curve.back().cmax << " is below the upper bound ";
+            cout << o.upperBound << ", check the instance and the evaluation\n";
+            belowBound = true;
+        }
+    }
+
+    // the classes in order, with the ARPD of the first run and of the best
+    cout << "\n  class    instances  first ARPD  best ARPD  mean ms  mean evaluations\n";
+    double sumFirst = 0, sumBest = 0, sumTime = 0;
+    for (size_t i = 0; i < outcomes.size(); )
+    {
+        size_t j = i;
+        double first = 0, best = 0, time = 0, evals = 0;
+        for (; j < outcomes.size() && outcomes[j].rows == outcomes[i].rows && outcomes[j].cols == outcomes[i].cols; ++j)
+        {
+            first += rpd(outcomes[j].curve.front().cmax, outcomes[j].upperBound);
+            best  += rpd(outcomes[j].curve.back().cmax, outcomes[j].upperBound);
+            time  += outcomes[j].time;
+            evals += outcomes[j].evals;
+        }
+
+        int n = j - i;
+        string name = to_string(outcomes[i].cols) + "x" + to_string(outcomes[i].rows);
+        printf("  %-8s %9d  %9.3f%%  %8.3f%%  %7.1f  %16.0f\n", name.c_str(), n, first / n, best / n, time / n, evals / n);
+
+        sumFirst += first;
+        sumBest  += best;
+        sumTime  += time;
+        i = j;
+    }
+
+    int n = outcomes.size();
+    printf("  %-8s %9d  %9.3f%%  %8.3f%%  %7.1f\n", "all", n, sumFirst / n, sumBest / n, sumTime / n);
+
+    mkdir("results", 0755);
+    mkdir(output.c_str(), 0755);
+    if (!writeResults(output, outcomes))
+    {
+        cout << "Could not write the results to " << output << "\n";
+        return 1;
+    }
+    cout << "\nResults in " << output << "/instances.csv, anytime curves in " << output << "/curves.csv\n";
+
+    return belowBound ? 1 : 0;
+}
@@ -0,0 +1,163 @@
+/**
+ * @file wavefront.cpp
+ * @author Matthew Harker
+ * @brief Evaluates one large random schedule with the wavefront evaluator
+ *          for a range of thread counts. Checks that the completion matrix
+ *          is identical to fssPerm()/fssbPerm() and reports the scaling,
+ *          with the tiles per anti-diagonal (the most threads the tiling
+ *          can keep busy). FSSB uses square tiles, by default sized for
+ *          each thread count with fssbTileSide().
+ *
+ *          usage: wavefront.out [jobs] [machines] [maxThreads] [tileRows] [tileCols] [fssbTile]
+ * @version 1.0
+ * @date 2019-06-05
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "fss.h"
+#include "fssb.h"
+#include "wavefront.h"
+
+using namespace std;
+
+/**
+ * @brief Returns the milliseconds since a point in time
+ *
+ * @param start     The point in time to measure from
+ * @return double   The elapsed milliseconds
+ */
+static double msSince(chrono::steady_clock::time_point start)
+{
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * @brief Checks if two matrices hold exactly the same values
+ *
+ * @param a     The first matrix
+ * @param b     The second matrix
+ * @return true If every element is equal
+ */
+static bool identical(Matrix* a, Matrix* b)
+{
+    for (int r = 0; r < a->getRows(); ++r)
+        if (!equal(a->getRow(r), a->getRow(r) + a->getCols(), b->getRow(r)))
+            return false;
+
+    return true;
+}
+
+/**
+ * @brief Runs one algorithm through the serial and the wavefront evaluators
+ *
+ * @param alg           1 for FSS, 2 for FSSB
+ * @param jobs          The job run time matrix
+ * @param perm          The job sequence
+ * @param threadCounts  The thread counts to measure
+ * @param tileRows      The height of an FSS tile
+ * @param tileCols      The width of an FSS tile
+ * @param fssbTile      The side of an FSSB tile, 0 to size it for each thread count
+ */
+static void measure(const int alg, Matrix* jobs, Permutation* perm, const vector<int>& threadCounts,
+                    const int tileRows, const int tileCols, const int fssbTile)
+{
+    Matrix* ref  = new Matrix(jobs->getRows(), jobs->getCols());
+    Matrix* comp = new Matrix(jobs->getRows(), jobs->getCols());
+
+    // the serial reference
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    int refCmax = (alg == 1) ? fssPerm(jobs, ref, perm) : fssbPerm(jobs, ref, perm);
+    double refTime = msSince(start);
+
+    cout << (alg == 1 ? "FSS" : "FSSB") << ": serial Cmax " << refCmax << " in " << refTime << " ms\n";
+    cout << "threads,tile,tiles_per_wave,time_ms,speedup,efficiency,identical\n";
+
+    double oneThread = 0;
+    for (size_t i = 0; i < threadCounts.size(); ++i)
+    {
+        ThreadPool tp(threadCounts[i]);
+        comp->clearMatrix();
+
+        int rows = tileRows, cols = tileCols;
+        if (alg == 2)
+            rows = cols = (fssbTile > 0) ? fssbTile : fssbTileSide(jobs->getRows(), threadCounts[i]);
+
+        start = chrono::steady_clock::now();
+        int cmax = (alg == 1) ? fssWavefront (jobs, comp, perm, &tp, rows, cols)
+                              : fssbWavefront(jobs, comp, perm, &tp, rows, cols);
+        double time = msSince(start);
+
+        if (i == 0) oneThread = time;
+        double speedup = oneThread / time;
+
+        cout << threadCounts[i] << "," << rows << "x" << cols << ",";
+        cout << waveWidth(rows, cols, jobs->getRows(), jobs->getCols(), alg == 2) << ",";
+        cout << time << "," << speedup << ",";
+        cout << speedup / threadCounts[i] << ",";
+        cout << ((cmax == refCmax && identical(comp, ref)) ? "yes" : "NO") << "\n";
+    }
+    cout << "\n";
+
+    delete ref;
+    delete comp;
+}
+
+int main(int argc, char** argv)
+{
+    int numJobs     = (argc > 1) ? atoi(argv[1]) : 20000;
+    int numMachines = (argc > 2) ? atoi(argv[2]) : 200;
+    int maxThreads  = (argc > 3) ? atoi(argv[3]) : thread::hardware_concurrency();
+    int tileRows    = (argc > 4) ? atoi(argv[4]) : WAVE_TILE_ROWS;
+    int tileCols    = (argc > 5) ? atoi(argv[5]) : WAVE_TILE_COLS;
+    int fssbTile    = (argc > 6) ? atoi(argv[6]) : 0;
+
+    if (numJobs < 1 || numMachines < 2 || tileRows < 1 || tileCols < 1 || fssbTile < 0)
+    {
+        cout << "usage: wavefront.out [jobs] [machines >= 2] [maxThreads] [tileRows] [tileCols] [fssbTile]\n";
+        return 1;
+    }
+    maxThreads = max(1, maxThreads);
+
+    // thread counts 1, 2, 4, ... and the maximum
+    vector<int> threadCounts;
+    for (int t = 1; t < maxThreads; t *= 2)
+        threadCounts.push_back(t);
+    threadCounts.push_back(maxThreads);
+
+    // a random instance and a random sequence
+    mt19937 mt(471);
+    uniform_int_distribution<int> times(1, 99);
+
+    Matrix* jobs = new Matrix(numMachines, numJobs);
+    for (int r = 0; r < numMachines; ++r)
+        for (int c = 0; c < numJobs; ++c)
+            jobs->setVal(times(mt), r, c);
+
+    vector<int> order(numJobs);
+    for (int c = 0; c < numJobs; ++c)
+        order[c] = c;
+    shuffle(order.begin(), order.end(), mt);
+
+    Permutation* perm = new Permutation(numJobs);
+    for (int c = 0; c < numJobs; ++c)
+        perm->addElement(order[c]);
+
+    cout << "Instance: " << numMachines << " machines x " << numJobs << " jobs, ";
+    cout << "FSS tiles " << tileRows << "x" << tileCols << "\n\n";
+
+    measure(1, jobs, perm, threadCounts, tileRows, tileCols, fssbTile);
+    measure(2, jobs, perm, threadCounts, tileRows, tileCols, fssbTile);
+
+    delete jobs;
+    delete perm;
+    return 0;
+}